@@ -1,12 +1,17 @@
 #include "expected_score_calculator.hpp"
 
-#include <algorithm> // max, fill
+#include <algorithm> // max, fill, find
+#include <atomic>
 #include <cassert>
+#include <chrono>
+#include <mutex>
 
-#include "mahjong/core/necessary_tile_calculator.hpp"
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "mahjong/core/incremental_tile_calculator.hpp"
 #include "mahjong/core/score_calculator.hpp"
-#include "mahjong/core/shanten_calculator.hpp"
-#include "mahjong/core/unnecessary_tile_calculator.hpp"
 #include "mahjong/core/utils.hpp"
 
 namespace mahjong
@@ -177,78 +182,26 @@ std::array<double, 13> calc_uradora_distribution(const MergedCount &wall,
     return probabilities;
 }
 
-double calc_uradora_score(const ExpectedScoreCalculator::Config &config,
-                          const TableConfig &table_config,
+double calc_uradora_score(const TableConfig &table_config,
                           const RoundState &round_state, const TableState &table_state,
-                          const PlayerState &player, const SeparatedCount &hand_counts,
-                          const SeparatedCount &wall_counts, const ScoreResult &result,
-                          const int win_flag)
+                          const PlayerState &player, const ScoreSummary &result,
+                          const int win_flag,
+                          const std::array<double, 13> &uradora_probabilities)
 {
-    const int num_indicators = table_state.dora_indicators.size();
-
-    // 裏ドラ表示牌の抽選では、赤5と通常5を同じ牌として扱う。
-    const MergedCount wall = to_merged_count(wall_counts);
-    MergedCount hand_and_melds = to_merged_count(hand_counts);
-    for (const auto &meld : player.melds) {
-        for (auto tile : meld.tiles) {
-            ++hand_and_melds[Tile::to_normal(tile)];
-        }
-    }
-
     // 裏ドラ枚数ごとの確率と、各枚数での点数を掛け合わせる。
-    const auto uradora_probabilities = calc_uradora_distribution(
-        wall, hand_and_melds, num_indicators, table_config.game_mode);
-    const std::vector<int> up_scores = ScoreCalculator::get_up_scores(
-        table_config, round_state, table_state, player, result, win_flag, 12);
-
     double score = 0;
     for (int i = 0; i <= 12; ++i) {
-        score += up_scores[i] * uradora_probabilities[i];
+        if (uradora_probabilities[i] > 0.0) {
+            score += ScoreCalculator::get_up_score(table_config, round_state,
+                                                   table_state, player, result,
+                                                   win_flag, i) *
+                     uradora_probabilities[i];
+        }
     }
 
     return score;
 }
 
-double calc_score(const ExpectedScoreCalculator::Config &config,
-                  const TableConfig &table_config, const RoundState &round_state,
-                  const TableState &table_state, PlayerState &player,
-                  SeparatedCount &hand_counts, SeparatedCount &wall_counts,
-                  const int shanten_type, const int win_tile, const bool riichi)
-{
-    // 期待値計算では和了を自摸和了として評価する。
-    int win_flag = riichi ? (WinFlag::Tsumo | WinFlag::Riichi) : WinFlag::Tsumo;
-
-    ScoreResult result =
-        ScoreCalculator::calc_fast(table_config, round_state, table_state, player,
-                                   win_tile, win_flag, shanten_type);
-
-    // 役なしの場合は0点とする。
-    if (!result.success) {
-        return 0.0;
-    }
-
-    // 裏ドラ期待値を計算しない場合は、通常の和了点を返す。
-    if (!config.enable_uradora || !(win_flag & WinFlag::Riichi) ||
-        table_state.dora_indicators.empty()) {
-        return result.payments[0];
-    }
-
-    // 役満以上は裏ドラで点数が変わらない。
-    if (result.score_limit >= ScoreLimit::CountedYakuman) {
-        return result.payments[0];
-    }
-
-    return calc_uradora_score(config, table_config, round_state, table_state, player,
-                              hand_counts, wall_counts, result, win_flag);
-}
-
-template <std::size_t N>
-std::vector<double> to_vector(const std::array<double, N> &values, const int t_max)
-{
-    assert(t_max >= 0 && t_max < static_cast<int>(N));
-    return {values.begin(), values.begin() + t_max + 1};
-}
-
 int distance(const SeparatedCount &hand, const SeparatedCount &hand_org)
 {
     int dist = 0;
@@ -272,18 +225,99 @@ get_necessary_tiles(const ExpectedScoreCalculator::Config &config,
                     const PlayerState &player, const MergedCount &wall,
                     const int game_mode)
 {
-    const auto [shanten_type, shanten, tiles] = NecessaryTileCalculator::select(
+    const HandAnalyzer::Result analysis = HandAnalyzer::calc(
         player.hand, player.num_melds(), config.shanten_type, game_mode);
 
     std::vector<std::tuple<int, int>> necessary_tiles;
-    necessary_tiles.reserve(tiles.size());
-    for (const auto tile : tiles) {
-        necessary_tiles.emplace_back(tile, wall[tile]);
+    necessary_tiles.reserve(34);
+    for (int tile = 0; tile < 34; ++tile) {
+        if (analysis.necessary_tiles & (INT64_C(1) << tile)) {
+            necessary_tiles.emplace_back(tile, wall[tile]);
+        }
     }
 
-    return {shanten, necessary_tiles};
+    return {analysis.shanten, necessary_tiles};
+}
+
+/**
+ * @brief Check whether the calculation has been cancelled by another thread.
+ */
+bool is_cancelled(const ExpectedScoreCalculator::Config &config)
+{
+    return config.cancel && config.cancel->load(std::memory_order_relaxed);
 }
 
+/**
+ * @brief The SearchBudget class limits the number of vertices and the time of the
+ *        search. Once the budget is exceeded, the builders stop the transitions
+ *        which do not advance the hand (tegawari and shanten down). Once the
+ *        calculation is cancelled, the builders stop all transitions. The budget is
+ *        shared by the builders of all threads.
+ */
+class SearchBudget
+{
+  public:
+    explicit SearchBudget(const ExpectedScoreCalculator::Config &config)
+        : config_(config)
+        , max_vertices_(static_cast<std::size_t>(std::max(config.max_vertices, 0)))
+        , time_budget_(config.time_budget > 0)
+        , deadline_(std::chrono::steady_clock::now() +
+                    std::chrono::milliseconds(config.time_budget))
+        , num_vertices_(0)
+        , exceeded_(false)
+    {
+    }
+
+    /**
+     * @brief Count a new vertex and check the budget.
+     *
+     * @return true if the transitions from the vertex may still be extended
+     */
+    bool add_vertex()
+    {
+        if (cancelled()) {
+            return false;
+        }
+        if (max_vertices_ == 0 && !time_budget_) {
+            return true;
+        }
+        if (exceeded_.load(std::memory_order_relaxed)) {
+            return false;
+        }
+
+        // 時刻の取得は重いため、一定数の頂点ごとに確認する。
+        const std::size_t n = num_vertices_.fetch_add(1, std::memory_order_relaxed) + 1;
+        if ((max_vertices_ > 0 && n >= max_vertices_) ||
+            (time_budget_ && n % TimeCheckInterval == 0 &&
+             std::chrono::steady_clock::now() >= deadline_)) {
+            exceeded_.store(true, std::memory_order_relaxed);
+            return false;
+        }
+
+        return true;
+    }
+
+    bool exceeded() const
+    {
+        return exceeded_.load(std::memory_order_relaxed);
+    }
+
+    bool cancelled() const
+    {
+        return is_cancelled(config_);
+    }
+
+  private:
+    static constexpr std::size_t TimeCheckInterval = 64;
+
+    const ExpectedScoreCalculator::Config &config_;
+    const std::size_t max_vertices_;
+    const bool time_budget_;
+    const std::chrono::steady_clock::time_point deadline_;
+    std::atomic<std::size_t> num_vertices_;
+    std::atomic<bool> exceeded_;
+};
+
 } // namespace
 
 MergedCount create_wall(const TableConfig &table_config, const TableState &table_state,
@@ -329,6 +363,264 @@ MergedCount create_wall(const TableConfig &table_config, const TableState &table
     return wall;
 }
 
+/**
+ * @brief The SharedCache class records which thread expands each vertex when the
+ *        graph is built in parallel. The keys are distributed to shards, each of
+ *        which is guarded by its own mutex.
+ */
+class ExpectedScoreCalculator::SharedCache
+{
+  public:
+    /**
+     * @brief Claim the vertex of the key.
+     *
+     * @param[in] key key of the vertex
+     * @param[in] is_draw whether the vertex is a draw node
+     * @param[in] owner thread and vertex to claim the key for
+     * @return owner of the vertex, which is the given one if the key is not claimed
+     */
+    Owner claim(const CacheKey &key, const bool is_draw, const Owner owner)
+    {
+        Shard &shard = shards_[CacheKeyHash()(key) >> (64 - ShardBits)];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto &owners = is_draw ? shard.draw_owners : shard.discard_owners;
+        return owners.try_emplace(key, owner).first->second;
+    }
+
+    void clear()
+    {
+        for (Shard &shard : shards_) {
+            shard.draw_owners.clear();
+            shard.discard_owners.clear();
+        }
+    }
+
+    std::size_t memory_usage() const
+    {
+        std::size_t usage = 0;
+        for (const Shard &shard : shards_) {
+            usage += (shard.draw_owners.bucket_count() +
+                      shard.discard_owners.bucket_count()) *
+                     (sizeof(OwnerMap::value_type) + 1);
+        }
+        return usage;
+    }
+
+  private:
+    static constexpr int ShardBits = 6;
+
+    using OwnerMap = boost::unordered_flat_map<CacheKey, Owner, CacheKeyHash>;
+
+    struct Shard
+    {
+        std::mutex mutex;
+        OwnerMap draw_owners;
+        OwnerMap discard_owners;
+    };
+
+    std::array<Shard, 1 << ShardBits> shards_;
+};
+
+/**
+ * @brief Get the number of bytes reserved by the buffers of the context.
+ *
+ * @return number of bytes
+ */
+std::size_t ExpectedScoreCalculator::Context::memory_usage() const
+{
+    const auto bytes = [](const auto &v) {
+        return v.capacity() * sizeof(typename std::decay_t<decltype(v)>::value_type);
+    };
+    // 1 byte of metadata per bucket is an approximation of boost::unordered_flat_map.
+    const auto cache_bytes = [](const Cache &cache) {
+        return cache.bucket_count() * (sizeof(Cache::value_type) + 1);
+    };
+
+    std::size_t usage = bytes(graph.is_tenpai) + bytes(graph.edge_tiles) +
+                        bytes(graph.out_degrees) + bytes(graph.in_degrees) +
+                        bytes(graph.edges);
+    usage += cache_bytes(draw_cache) + cache_bytes(discard_cache);
+    usage += uradora_cache.bucket_count() * (sizeof(UradoraCache::value_type) + 1);
+    usage += bytes(draw_vertices) + bytes(discard_vertices);
+    usage += bytes(edge_csr.draw_edges) + bytes(edge_csr.selection_edges) +
+             bytes(edge_csr.draw_edge_offsets) + bytes(edge_csr.selection_edge_offsets);
+    for (const auto &column : table.values) {
+        usage += bytes(column);
+    }
+    usage += bytes(foreign_vertices);
+    for (const auto &context : thread_contexts) {
+        usage += context.memory_usage();
+    }
+    if (shared_cache) {
+        usage += shared_cache->memory_usage();
+    }
+
+    return usage;
+}
+
+/**
+ * @brief Free the buffers of the context. The peak memory usage is kept.
+ */
+void ExpectedScoreCalculator::Context::release()
+{
+    const std::size_t peak_memory_usage = peak_memory_usage_;
+    *this = Context();
+    peak_memory_usage_ = peak_memory_usage;
+}
+
+void ExpectedScoreCalculator::Context::clear()
+{
+    graph.clear();
+    draw_cache.clear();
+    discard_cache.clear();
+    draw_vertices.clear();
+    discard_vertices.clear();
+    uradora_cache.clear();
+    foreign_vertices.clear();
+}
+
+/**
+ * @brief Find the symmetries which keep the statistics of every hand in the search.
+ *        A symmetry is allowed if it keeps the original hand, the tiles in the hand
+ *        and the wall, the melds and the dora. The suits are permuted only among
+ *        those which keep the all green hand (souzu is fixed while the hand can
+ *        be all green), and the numbers are mirrored only if the uradora, whose
+ *        indicators are not mirrored, is not evaluated.
+ *
+ * @param[in] config configuration
+ * @param[in] table_config table configuration
+ * @param[in] table_state table state
+ * @param[in] player player state
+ * @param[in] hand_counts original hand
+ * @param[in] wall_counts original wall
+ * @return list of symmetries except the identity
+ */
+std::vector<ExpectedScoreCalculator::Symmetry> ExpectedScoreCalculator::find_symmetries(
+    const Config &config, const TableConfig &table_config,
+    const TableState &table_state, const PlayerState &player,
+    const SeparatedCount &hand_counts, const SeparatedCount &wall_counts)
+{
+    std::vector<Symmetry> symmetries;
+    if (!config.enable_symmetry) {
+        return symmetries;
+    }
+
+    const auto is_green = [](const int tile) {
+        return tile == Tile::Souzu2 || tile == Tile::Souzu3 || tile == Tile::Souzu4 ||
+               tile == Tile::Souzu6 || tile == Tile::Souzu8 ||
+               tile == Tile::GreenDragon;
+    };
+    bool all_green = true;
+    for (const auto &meld : player.melds) {
+        for (const int tile : meld.tiles) {
+            all_green &= is_green(Tile::to_normal(tile));
+        }
+    }
+    const bool uradora = config.enable_uradora && player.is_closed() &&
+                         !table_state.dora_indicators.empty();
+
+    SeparatedCount dora_counts{0};
+    for (const int indicator : table_state.dora_indicators) {
+        const int dora =
+            Tile::to_dora(Tile::to_normal(indicator), table_config.game_mode);
+        ++dora_counts[dora];
+    }
+
+    const auto sorted_melds = [&player](const Symmetry &symmetry) {
+        std::vector<std::pair<int, std::vector<int>>> melds;
+        for (const auto &meld : player.melds) {
+            std::vector<int> tiles;
+            for (const int tile : meld.tiles) {
+                tiles.push_back(symmetry.map(tile));
+            }
+            std::sort(tiles.begin(), tiles.end());
+            melds.emplace_back(meld.type, tiles);
+        }
+        std::sort(melds.begin(), melds.end());
+        return melds;
+    };
+    const auto melds = sorted_melds(Symmetry());
+
+    Symmetry symmetry;
+    do {
+        for (const bool mirror : {false, true}) {
+            symmetry.mirror = mirror;
+            const bool identity = symmetry.suits == std::array<int, 3>{0, 1, 2};
+            if ((identity && !mirror) || (mirror && uradora) ||
+                ((symmetry.suits[2] != 2 || mirror) && all_green)) {
+                continue;
+            }
+
+            bool allowed = true;
+            for (int i = 0; i < 37 && allowed; ++i) {
+                const int j = symmetry.map(i);
+                allowed = hand_counts[j] == hand_counts[i] &&
+                          wall_counts[j] == wall_counts[i] &&
+                          dora_counts[j] == dora_counts[i];
+            }
+            if (allowed && sorted_melds(symmetry) == melds) {
+                symmetries.push_back(symmetry);
+            }
+        }
+    } while (std::next_permutation(symmetry.suits.begin(), symmetry.suits.end()));
+
+    return symmetries;
+}
+
+/**
+ * @brief Create the key of the hand which is the smallest among the hands mapped by
+ *        the symmetries.
+ *
+ * @param[in] symmetries list of symmetries except the identity
+ * @param[in] hand hand
+ * @param[in] riichi whether the player has declared riichi
+ * @param[out] symmetry symmetry which maps the hand to the canonical one
+ * @return canonical key
+ */
+ExpectedScoreCalculator::CacheKey
+ExpectedScoreCalculator::canonical_key(const std::vector<Symmetry> &symmetries,
+                                       const SeparatedCount &hand, const bool riichi,
+                                       Symmetry &symmetry)
+{
+    CacheKey key(hand, riichi);
+    symmetry = Symmetry();
+    if (symmetries.empty()) {
+        return key;
+    }
+
+    // 各色の並びを正順、逆順で符号化しておき、対称変換後の鍵を組み立てる。
+    std::array<int32_t, 3> codes{key.manzu, key.pinzu, key.souzu};
+    std::array<int32_t, 3> mirrored_codes{0, 0, 0};
+    for (int suit = 0; suit < 3; ++suit) {
+        for (int number = 8; number >= 0; --number) {
+            mirrored_codes[suit] = mirrored_codes[suit] * 8 + hand[suit * 9 + number];
+        }
+    }
+    const int32_t honors = key.honors & ~(7 << 21);
+
+    for (const Symmetry &candidate : symmetries) {
+        std::array<int32_t, 3> suits;
+        int32_t image_honors = honors;
+        for (int suit = 0; suit < 3; ++suit) {
+            const int image = candidate.suits[suit];
+            suits[image] = candidate.mirror ? mirrored_codes[suit] : codes[suit];
+            image_honors |= hand[Tile::RedManzu5 + suit] << (21 + image);
+        }
+
+        CacheKey image = key;
+        image.manzu = suits[0];
+        image.pinzu = suits[1];
+        image.souzu = suits[2];
+        image.honors = image_honors;
+        if (image < key) {
+            key = image;
+            symmetry = candidate;
+        }
+    }
+
+    return key;
+}
+
 class ExpectedScoreCalculator::GraphBuilder
 {
   public:
@@ -336,7 +628,7 @@ class ExpectedScoreCalculator::GraphBuilder
                  const RoundState &round_state, const TableState &table_state,
                  PlayerState &player, SeparatedCount &hand_counts,
                  SeparatedCount &wall_counts, const SeparatedCount &hand_org,
-                 const int shanten_org)
+                 const int shanten_org, Context &context, SearchBudget &budget)
         : config_(config)
         , table_config_(table_config)
         , round_state_(round_state)
@@ -346,34 +638,80 @@ class ExpectedScoreCalculator::GraphBuilder
         , wall_counts_(wall_counts)
         , hand_org_(hand_org)
         , shanten_org_(shanten_org)
+        , calculator_(player.hand, player.num_melds(), config.shanten_type,
+                      table_config.game_mode)
+        , graph_(context.graph)
+        , cache1_(context.draw_cache)
+        , cache2_(context.discard_cache)
+        , draw_vertices_(context.draw_vertices)
+        , discard_vertices_(context.discard_vertices)
+        , foreign_vertices_(context.foreign_vertices)
+        , symmetries_(context.symmetries)
+        , uradora_cache_(context.uradora_cache)
+        , budget_(budget)
     {
     }
 
     Vertex draw_node(bool riichi);
     Vertex discard_node(bool riichi);
+#ifdef _OPENMP
+    void discard_node_parallel(Context &context);
+#endif
+    void extend();
 
-    Graph &graph()
+    /**
+     * @brief Record the vertices whose transitions are limited by the range of
+     *        exchanges, so that extend() can expand them later.
+     */
+    void enable_refinement()
     {
-        return graph_;
+        refinement_ = true;
     }
-    const Cache &draw_cache() const
+
+  private:
+    /* vertex whose tegawari or shanten down is limited by the range of exchanges */
+    struct LimitedVertex
     {
-        return cache1_;
-    }
-    const Cache &discard_cache() const
+        Vertex vertex;
+        CacheKey key;
+        /* range of exchanges required to expand the vertex */
+        int extra;
+        bool is_draw;
+    };
+
+#ifdef _OPENMP
+    bool is_foreign(const CacheKey &key, bool is_draw, Vertex &vertex);
+    void merge(const std::vector<Context> &contexts);
+#endif
+    Vertex draw_node(const CacheKey &key, const Symmetry &symmetry);
+    void expand_draw_node(Vertex vertex, const CacheKey &key, const Symmetry &symmetry,
+                          int type, int shanten, int64_t wait, bool in_budget);
+    void expand_discard_node(Vertex vertex, const CacheKey &key, int type, int shanten,
+                             int64_t disc, bool in_budget);
+    void add_discard_edge(Vertex vertex, int tile, int type, int shanten, bool is_disc,
+                          bool riichi);
+    bool can_extend_search(Vertex vertex, const CacheKey &key, int shanten,
+                           bool is_draw, bool in_budget);
+    void set_hand(const SeparatedCount &hand);
+    double calc_score(int shanten_type, int win_tile, bool riichi);
+    const std::array<double, 13> &uradora_distribution();
+
+    CacheKey make_key(const bool riichi, Symmetry &symmetry) const
     {
-        return cache2_;
+        return canonical_key(symmetries_, hand_counts_, riichi, symmetry);
     }
-    const std::vector<Vertex> &draw_vertices() const
+
+    void draw_tile(const int tile)
     {
-        return draw_vertices_;
+        draw(player_, hand_counts_, wall_counts_, tile);
+        calculator_.draw(tile);
     }
-    const std::vector<Vertex> &discard_vertices() const
+    void discard_tile(const int tile)
     {
-        return discard_vertices_;
+        discard(player_, hand_counts_, wall_counts_, tile);
+        calculator_.discard(tile);
     }
 
-  private:
     const Config &config_;
     const TableConfig &table_config_;
     const RoundState &round_state_;
@@ -383,115 +721,578 @@ class ExpectedScoreCalculator::GraphBuilder
     SeparatedCount &wall_counts_;
     const SeparatedCount &hand_org_;
     const int shanten_org_;
-    Graph graph_;
-    Cache cache1_;
-    Cache cache2_;
-    std::vector<Vertex> draw_vertices_;
-    std::vector<Vertex> discard_vertices_;
+    IncrementalTileCalculator calculator_;
+    Graph &graph_;
+    Cache &cache1_;
+    Cache &cache2_;
+    std::vector<Vertex> &draw_vertices_;
+    std::vector<Vertex> &discard_vertices_;
+    std::vector<std::pair<Vertex, Owner>> &foreign_vertices_;
+    const std::vector<Symmetry> &symmetries_;
+    UradoraCache &uradora_cache_;
+    std::array<double, 13> uradora_probabilities_;
+    SearchBudget &budget_;
+    bool refinement_ = false;
+    std::vector<LimitedVertex> limited_vertices_;
+#ifdef _OPENMP
+    SharedCache *shared_cache_ = nullptr;
+    std::uint32_t thread_ = 0;
+#endif
 };
 
 ExpectedScoreCalculator::Vertex
 ExpectedScoreCalculator::GraphBuilder::draw_node(const bool riichi)
 {
-    const CacheKey key(hand_counts_, riichi);
+    Symmetry symmetry;
+    const CacheKey key = make_key(riichi, symmetry);
+
+    return draw_node(key, symmetry);
+}
+
+/**
+ * @brief Get the draw node of the hand, or add it if it does not exist.
+ *
+ * @param[in] key canonical key of the hand
+ * @param[in] symmetry symmetry which maps the hand to the canonical one
+ * @return draw node
+ */
+ExpectedScoreCalculator::Vertex
+ExpectedScoreCalculator::GraphBuilder::draw_node(const CacheKey &key,
+                                                 const Symmetry &symmetry)
+{
     if (const auto itr = cache1_.find(key); itr != cache1_.end()) {
         return itr->second;
     }
+#ifdef _OPENMP
+    if (Vertex vertex; is_foreign(key, true, vertex)) {
+        return vertex;
+    }
+#endif
 
-    auto [type, shanten, wait] =
-        NecessaryTileCalculator::calc(player_.hand, player_.num_melds(),
-                                      config_.shanten_type, table_config_.game_mode);
-
-    const bool can_extend_search =
-        distance(hand_counts_, hand_org_) + shanten < shanten_org_ + config_.extra;
-    const bool allow_tegawari = config_.enable_tegawari && !riichi && can_extend_search;
-    wait = add_red5_flags(wait);
+    const auto [type, shanten, wait] = calculator_.result();
 
-    const Vertex vertex = graph_.add_vertex();
-    graph_[vertex].is_tenpai = shanten == 0;
+    const Vertex vertex = graph_.add_vertex(shanten == 0);
     cache1_[key] = vertex;
     draw_vertices_.push_back(vertex);
 
+    expand_draw_node(vertex, key, symmetry, type, shanten, wait, budget_.add_vertex());
+
+    return vertex;
+}
+
+/**
+ * @brief Add the transitions from the draw node by drawing tiles.
+ *        The transitions which already exist are skipped.
+ *
+ * @param[in] vertex draw node
+ * @param[in] key key of the draw node
+ * @param[in] symmetry symmetry which maps the hand to the canonical one
+ * @param[in] type shanten flag of the hand
+ * @param[in] shanten shanten number of the hand
+ * @param[in] wait necessary tiles of the hand
+ * @param[in] in_budget whether the search budget remains
+ */
+void ExpectedScoreCalculator::GraphBuilder::expand_draw_node(
+    const Vertex vertex, const CacheKey &key, const Symmetry &symmetry, const int type,
+    const int shanten, int64_t wait, const bool in_budget)
+{
+    if (budget_.cancelled()) {
+        return;
+    }
+
+    const bool riichi = key.riichi();
+    const bool allow_tegawari =
+        config_.enable_tegawari && !riichi &&
+        can_extend_search(vertex, key, shanten, true, in_budget);
+    wait = add_red5_flags(wait);
+
     for (int i = 0; i < 37; ++i) {
         const bool is_wait = wait & (1LL << i);
 
         if (wall_counts_[i] && (allow_tegawari || is_wait)) {
             const int weight = wall_counts_[i];
 
-            draw(player_, hand_counts_, wall_counts_, i);
+            draw_tile(i);
 
             const Vertex target = discard_node(riichi);
 
-            if (!graph_.has_edge(vertex, target)) {
+            // 辺は標準形の手牌での牌で識別する。
+            const int tile = symmetry.map(i);
+            if (!graph_.has_edge(vertex, tile, riichi)) {
                 // 自摸前の時点で聴牌の場合、有効牌自摸後は和了形のため、点数計算を行う
                 double score = 0.0;
                 if (shanten == 0 && is_wait) {
-                    score = calc_score(config_, table_config_, round_state_,
-                                       table_state_, player_, hand_counts_,
-                                       wall_counts_, type, i, riichi);
+                    score = calc_score(type, i, riichi);
                 }
-                graph_.add_edge(vertex, target, weight, score);
+                graph_.add_edge(vertex, target, tile, riichi, weight, score);
             }
 
-            discard(player_, hand_counts_, wall_counts_, i);
+            discard_tile(i);
         }
     }
-
-    return vertex;
 }
 
 ExpectedScoreCalculator::Vertex
 ExpectedScoreCalculator::GraphBuilder::discard_node(const bool riichi)
 {
-    const CacheKey key(hand_counts_, riichi);
+    Symmetry symmetry;
+    const CacheKey key = make_key(riichi, symmetry);
     if (const auto itr = cache2_.find(key); itr != cache2_.end()) {
         return itr->second;
     }
+#ifdef _OPENMP
+    if (Vertex vertex; is_foreign(key, false, vertex)) {
+        return vertex;
+    }
+#endif
 
-    auto [type, shanten, disc] =
-        UnnecessaryTileCalculator::calc(player_.hand, player_.num_melds(),
-                                        config_.shanten_type, table_config_.game_mode);
-
-    const bool can_extend_search =
-        distance(hand_counts_, hand_org_) + shanten < shanten_org_ + config_.extra;
-    const bool allow_shanten_down =
-        config_.enable_shanten_down && !riichi && can_extend_search;
-    disc = add_red5_flags(disc);
+    const auto [type, shanten, disc] = calculator_.result();
 
-    const Vertex vertex = graph_.add_vertex();
-    graph_[vertex].is_tenpai = shanten == 0;
+    const Vertex vertex = graph_.add_vertex(shanten == 0);
     cache2_[key] = vertex;
     discard_vertices_.push_back(vertex);
 
+    expand_discard_node(vertex, key, type, shanten, disc, budget_.add_vertex());
+
+    return vertex;
+}
+
+/**
+ * @brief Add the transitions to the discard node from the draw nodes reached by
+ *        discarding tiles. The transitions which already exist are skipped.
+ *
+ * @param[in] vertex discard node
+ * @param[in] key key of the discard node
+ * @param[in] type shanten flag of the hand
+ * @param[in] shanten shanten number of the hand
+ * @param[in] disc unnecessary tiles of the hand
+ * @param[in] in_budget whether the search budget remains
+ */
+void ExpectedScoreCalculator::GraphBuilder::expand_discard_node(
+    const Vertex vertex, const CacheKey &key, const int type, const int shanten,
+    int64_t disc, const bool in_budget)
+{
+    if (budget_.cancelled()) {
+        return;
+    }
+
+    const bool riichi = key.riichi();
+    const bool allow_shanten_down =
+        config_.enable_shanten_down && !riichi &&
+        can_extend_search(vertex, key, shanten, false, in_budget);
+    disc = add_red5_flags(disc);
+
     for (int i = 0; i < 37; ++i) {
         const bool is_disc = disc & (1LL << i);
 
         if (hand_counts_[i] && (allow_shanten_down || is_disc)) {
-            const bool call_riichi =
-                player_.is_closed() && shanten == 0 && is_disc ? true : riichi;
+            add_discard_edge(vertex, i, type, shanten, is_disc, riichi);
+        }
+    }
+}
 
-            discard(player_, hand_counts_, wall_counts_, i);
+/**
+ * @brief Add the transition to the discard node from the draw node reached by
+ *        discarding the tile, unless it already exists.
+ *
+ * @param[in] vertex discard node
+ * @param[in] tile tile to discard
+ * @param[in] type shanten flag of the hand
+ * @param[in] shanten shanten number of the hand
+ * @param[in] is_disc whether the tile is an unnecessary tile
+ * @param[in] riichi whether the player has declared riichi
+ */
+void ExpectedScoreCalculator::GraphBuilder::add_discard_edge(
+    const Vertex vertex, const int tile, const int type, const int shanten,
+    const bool is_disc, const bool riichi)
+{
+    const bool call_riichi =
+        player_.is_closed() && shanten == 0 && is_disc ? true : riichi;
+
+    discard_tile(tile);
+
+    const int weight = wall_counts_[tile];
+    Symmetry symmetry;
+    const CacheKey source_key = make_key(call_riichi, symmetry);
+    const Vertex source = draw_node(source_key, symmetry);
+
+    draw_tile(tile);
+
+    // 辺は標準形の手牌での牌で識別する。標準形の手牌を変えない対称変換がある場合、
+    // 対称な牌の自摸も同じ頂点に遷移するため、それらの辺も追加する。
+    std::array<int, 12> edge_tiles;
+    int num_edge_tiles = 0;
+    edge_tiles[num_edge_tiles++] = symmetry.map(tile);
+    if (!symmetries_.empty()) {
+        const SeparatedCount source_hand = source_key.hand();
+        for (const Symmetry &candidate : symmetries_) {
+            bool keeps_hand = true;
+            for (int i = 0; i < 37 && keeps_hand; ++i) {
+                keeps_hand = source_hand[candidate.map(i)] == source_hand[i];
+            }
 
-            const int weight = wall_counts_[i];
-            const Vertex source = draw_node(call_riichi);
+            const int image = candidate.map(edge_tiles[0]);
+            if (keeps_hand && std::find(edge_tiles.begin(),
+                                        edge_tiles.begin() + num_edge_tiles,
+                                        image) == edge_tiles.begin() + num_edge_tiles) {
+                edge_tiles[num_edge_tiles++] = image;
+            }
+        }
+    }
 
-            draw(player_, hand_counts_, wall_counts_, i);
+    double score = 0.0;
+    bool scored = false;
+    for (int k = 0; k < num_edge_tiles; ++k) {
+        if (graph_.has_edge(source, edge_tiles[k], riichi)) {
+            continue;
+        }
 
-            if (!graph_.has_edge(source, vertex)) {
-                // 打牌前の時点で向聴数が-1の場合、和了形のため、点数計算を行う
-                double score = 0.0;
-                if (shanten == -1) {
-                    score = calc_score(config_, table_config_, round_state_,
-                                       table_state_, player_, hand_counts_,
-                                       wall_counts_, type, i, riichi);
-                }
-                graph_.add_edge(source, vertex, weight, score);
+        // 打牌前の時点で向聴数が-1の場合、和了形のため、点数計算を行う
+        if (shanten == -1 && !scored) {
+            score = calc_score(type, tile, riichi);
+            scored = true;
+        }
+        graph_.add_edge(source, vertex, edge_tiles[k], riichi, weight, score);
+    }
+}
+
+/**
+ * @brief Check whether the transitions which do not advance the hand (tegawari and
+ *        shanten down) are searched from the vertex. If not, the vertex is recorded
+ *        for extend() when the refinement is enabled.
+ *
+ * @param[in] vertex vertex
+ * @param[in] key key of the vertex
+ * @param[in] shanten shanten number of the hand
+ * @param[in] is_draw whether the vertex is a draw node
+ * @param[in] in_budget whether the search budget remains
+ * @return true if the transitions are searched, otherwise false
+ */
+bool ExpectedScoreCalculator::GraphBuilder::can_extend_search(
+    const Vertex vertex, const CacheKey &key, const int shanten, const bool is_draw,
+    const bool in_budget)
+{
+    const int extra = distance(hand_counts_, hand_org_) + shanten - shanten_org_ + 1;
+    if (in_budget && extra <= config_.extra) {
+        return true;
+    }
+
+    // 立直後は手変わり、向聴戻しを行わないため、記録しない。
+    if (refinement_ && !key.riichi() &&
+        (is_draw ? config_.enable_tegawari : config_.enable_shanten_down)) {
+        limited_vertices_.push_back(LimitedVertex{vertex, key, extra, is_draw});
+    }
+
+    return false;
+}
+
+/**
+ * @brief Expand the vertices whose transitions were limited by the range of
+ *        exchanges, after config.extra is increased. The graph becomes the same as
+ *        the one built with the new range from the start.
+ */
+void ExpectedScoreCalculator::GraphBuilder::extend()
+{
+    const SeparatedCount hand_counts = hand_counts_;
+
+    std::vector<LimitedVertex> limited;
+    limited.swap(limited_vertices_);
+    for (const LimitedVertex &limited_vertex : limited) {
+        // 探索範囲外の頂点は次回以降に展開する。
+        if (limited_vertex.extra > config_.extra) {
+            limited_vertices_.push_back(limited_vertex);
+            continue;
+        }
+
+        set_hand(limited_vertex.key.hand());
+        const auto [type, shanten, tiles] = calculator_.result();
+        if (limited_vertex.is_draw) {
+            expand_draw_node(limited_vertex.vertex, limited_vertex.key, Symmetry(),
+                             type, shanten, tiles, !budget_.exceeded());
+        }
+        else {
+            expand_discard_node(limited_vertex.vertex, limited_vertex.key, type,
+                                shanten, tiles, !budget_.exceeded());
+        }
+    }
+
+    set_hand(hand_counts);
+}
+
+/**
+ * @brief Replace the hand of the builder.
+ *
+ * @param[in] hand hand
+ */
+void ExpectedScoreCalculator::GraphBuilder::set_hand(const SeparatedCount &hand)
+{
+    for (int i = 0; i < 37; ++i) {
+        wall_counts_[i] += hand_counts_[i] - hand[i];
+    }
+    hand_counts_ = hand;
+    player_.hand = to_merged_count(hand);
+    calculator_ = IncrementalTileCalculator(player_.hand, player_.num_melds(),
+                                            config_.shanten_type,
+                                            table_config_.game_mode);
+}
+
+/**
+ * @brief Calculate the score of winning with the current hand by tsumo.
+ *
+ * @param[in] shanten_type shanten flag of the hand
+ * @param[in] win_tile winning tile
+ * @param[in] riichi whether the player has declared riichi
+ * @return score, or the expected score over the uradora if riichi is declared
+ */
+double ExpectedScoreCalculator::GraphBuilder::calc_score(const int shanten_type,
+                                                         const int win_tile,
+                                                         const bool riichi)
+{
+    // 期待値計算では和了を自摸和了として評価する。
+    int win_flag = riichi ? (WinFlag::Tsumo | WinFlag::Riichi) : WinFlag::Tsumo;
+
+    const ScoreSummary result =
+        ScoreCalculator::calc_summary(table_config_, round_state_, table_state_,
+                                      player_, win_tile, win_flag, shanten_type);
+
+    // 役なしの場合は0点とする。
+    if (!result.success) {
+        return 0.0;
+    }
+
+    // 裏ドラ期待値を計算しない場合は、通常の和了点を返す。
+    if (!config_.enable_uradora || !(win_flag & WinFlag::Riichi) ||
+        table_state_.dora_indicators.empty()) {
+        return result.payments[0];
+    }
+
+    // 役満以上は裏ドラで点数が変わらない。
+    if (result.score_limit >= ScoreLimit::CountedYakuman) {
+        return result.payments[0];
+    }
+
+    return calc_uradora_score(table_config_, round_state_, table_state_, player_,
+                              result, win_flag, uradora_distribution());
+}
+
+/**
+ * @brief Get the distribution of the number of uradora of the current hand.
+ *        The wall is determined by the hand during a calculation, so the
+ *        distribution is cached by the hand and shared by all the winning tiles.
+ *
+ * @return probabilities indexed by the number of uradora
+ */
+const std::array<double, 13> &
+ExpectedScoreCalculator::GraphBuilder::uradora_distribution()
+{
+    // 裏ドラ表示牌の抽選では、赤5と通常5を同じ牌として扱う。
+    MergedCount hand_and_melds = to_merged_count(hand_counts_);
+    normalize_red_fives(hand_and_melds);
+
+    const CacheKey key(hand_and_melds, false);
+    if (config_.enable_uradora_cache) {
+        if (const auto itr = uradora_cache_.find(key); itr != uradora_cache_.end()) {
+            return itr->second;
+        }
+    }
+
+    for (const auto &meld : player_.melds) {
+        for (auto tile : meld.tiles) {
+            ++hand_and_melds[Tile::to_normal(tile)];
+        }
+    }
+    MergedCount wall = to_merged_count(wall_counts_);
+    normalize_red_fives(wall);
+
+    const int num_indicators = table_state_.dora_indicators.size();
+    std::array<double, 13> &probabilities =
+        config_.enable_uradora_cache ? uradora_cache_[key] : uradora_probabilities_;
+    probabilities = calc_uradora_distribution(wall, hand_and_melds, num_indicators,
+                                              table_config_.game_mode);
+    return probabilities;
+}
+
+#ifdef _OPENMP
+/**
+ * @brief Build the graph from the discard node of the hand in parallel.
+ *        Each thread builds the subgraphs after some of the discards. A vertex is
+ *        expanded only by the thread which claims it first, and the other threads
+ *        refer to it with a placeholder vertex. The subgraphs are merged at the end.
+ *
+ * @param[in] context context of the calculation
+ */
+void ExpectedScoreCalculator::GraphBuilder::discard_node_parallel(Context &context)
+{
+    const int num_threads = omp_get_max_threads();
+    if (context.thread_contexts.size() < static_cast<std::size_t>(num_threads)) {
+        context.thread_contexts.resize(num_threads);
+    }
+    if (!context.shared_cache) {
+        context.shared_cache = std::make_shared<SharedCache>();
+    }
+    SharedCache &shared_cache = *context.shared_cache;
+    shared_cache.clear();
+    for (Context &thread_context : context.thread_contexts) {
+        thread_context.clear();
+        thread_context.symmetries = symmetries_;
+    }
+
+    Symmetry symmetry;
+    const CacheKey key = make_key(false, symmetry);
+
+    auto [type, shanten, disc] = calculator_.result();
+
+    // 打牌前の頂点は1番目のスレッドの頂点0とする。
+    const Vertex root = 0;
+    {
+        Context &thread_context = context.thread_contexts[0];
+        thread_context.graph.add_vertex(shanten == 0);
+        thread_context.discard_cache[key] = root;
+        thread_context.discard_vertices.push_back(root);
+        shared_cache.claim(key, false, Owner{0, root});
+    }
+
+    // 打牌の選び方は expand_discard_node() と同じにする。
+    const bool allow_shanten_down =
+        config_.enable_shanten_down &&
+        can_extend_search(root, key, shanten, false, budget_.add_vertex());
+    disc = add_red5_flags(disc);
+
+    int tiles[37];
+    int num_tiles = 0;
+    for (int i = 0; i < 37; ++i) {
+        if (hand_counts_[i] && (allow_shanten_down || (disc & (1LL << i)))) {
+            tiles[num_tiles++] = i;
+        }
+    }
+
+#pragma omp parallel num_threads(num_threads)
+    {
+        const int thread = omp_get_thread_num();
+        PlayerState player = player_;
+        SeparatedCount hand_counts = hand_counts_;
+        SeparatedCount wall_counts = wall_counts_;
+        GraphBuilder builder(config_, table_config_, round_state_, table_state_, player,
+                             hand_counts, wall_counts, hand_org_, shanten_org_,
+                             context.thread_contexts[thread], budget_);
+        builder.shared_cache_ = &shared_cache;
+        builder.thread_ = static_cast<std::uint32_t>(thread);
+
+        Vertex vertex = root;
+        if (thread != 0) {
+            vertex = builder.graph_.add_vertex(false);
+            builder.cache2_[key] = vertex;
+            builder.foreign_vertices_.emplace_back(vertex, Owner{0, root});
+        }
+
+#pragma omp for schedule(dynamic)
+        for (int k = 0; k < num_tiles; ++k) {
+            const int i = tiles[k];
+            builder.add_discard_edge(vertex, i, type, shanten, disc & (1LL << i),
+                                     false);
+        }
+    }
+
+    merge(context.thread_contexts);
+}
+
+/**
+ * @brief Check whether the vertex of the key is expanded by another thread.
+ *        If so, add a placeholder vertex referring to it.
+ *
+ * @param[in] key key of the vertex
+ * @param[in] is_draw whether the vertex is a draw node
+ * @param[out] vertex placeholder vertex
+ * @return true if the vertex is expanded by another thread, otherwise false
+ */
+bool ExpectedScoreCalculator::GraphBuilder::is_foreign(const CacheKey &key,
+                                                       const bool is_draw,
+                                                       Vertex &vertex)
+{
+    if (!shared_cache_) {
+        return false;
+    }
+
+    // 次に追加する頂点として登録を試みる。
+    const Vertex next = static_cast<Vertex>(graph_.num_vertices());
+    const Owner owner = shared_cache_->claim(key, is_draw, Owner{thread_, next});
+    if (owner.thread == thread_) {
+        assert(owner.vertex == next);
+        return false;
+    }
+
+    vertex = graph_.add_vertex(false);
+    (is_draw ? cache1_ : cache2_)[key] = vertex;
+    foreign_vertices_.emplace_back(vertex, owner);
+
+    return true;
+}
+
+/**
+ * @brief Merge the subgraphs built by the threads into the graph.
+ *
+ * @param[in] contexts contexts of the threads
+ */
+void ExpectedScoreCalculator::GraphBuilder::merge(const std::vector<Context> &contexts)
+{
+    std::vector<std::vector<Vertex>> vertices(contexts.size());
+
+    // 各スレッドが展開した頂点を追加する。
+    for (std::size_t thread = 0; thread < contexts.size(); ++thread) {
+        const Context &context = contexts[thread];
+        const Graph &graph = context.graph;
+
+        std::vector<const CacheKey *> keys(graph.num_vertices(), nullptr);
+        std::vector<std::uint8_t> is_draw(graph.num_vertices(), 0);
+        for (const auto &[key, vertex] : context.draw_cache) {
+            keys[vertex] = &key;
+            is_draw[vertex] = 1;
+        }
+        for (const auto &[key, vertex] : context.discard_cache) {
+            keys[vertex] = &key;
+        }
+        for (const auto &[vertex, owner] : context.foreign_vertices) {
+            keys[vertex] = nullptr;
+        }
+
+        vertices[thread].resize(graph.num_vertices());
+        for (std::size_t vi = 0; vi < graph.num_vertices(); ++vi) {
+            if (!keys[vi]) {
+                continue;
+            }
+
+            const Vertex vertex = graph_.add_vertex(graph.is_tenpai[vi]);
+            if (is_draw[vi]) {
+                cache1_[*keys[vi]] = vertex;
+                draw_vertices_.push_back(vertex);
             }
+            else {
+                cache2_[*keys[vi]] = vertex;
+                discard_vertices_.push_back(vertex);
+            }
+            vertices[thread][vi] = vertex;
         }
     }
 
-    return vertex;
+    // 他のスレッドが展開した頂点を対応付ける。
+    for (std::size_t thread = 0; thread < contexts.size(); ++thread) {
+        for (const auto &[vertex, owner] : contexts[thread].foreign_vertices) {
+            vertices[thread][vertex] = vertices[owner.thread][owner.vertex];
+        }
+    }
+
+    // 辺を追加する。複数のスレッドで作成された辺は1つにまとめる。
+    for (std::size_t thread = 0; thread < contexts.size(); ++thread) {
+        for (const EdgeData &edge : contexts[thread].graph.edges) {
+            const Vertex source = vertices[thread][edge.source];
+            if (!graph_.has_edge(source, edge.tile, edge.riichi)) {
+                graph_.add_edge(source, vertices[thread][edge.target], edge.tile,
+                                edge.riichi, edge.weight, edge.score);
+            }
+        }
+    }
 }
+#endif
 
 /**
  * @brief Calculate the probability of tenpai, the probability of winning, and the expected score.
@@ -501,107 +1302,114 @@ ExpectedScoreCalculator::GraphBuilder::discard_node(const bool riichi)
  * @param cache1 List of draw node
  * @param cache2 List of discard node
  */
-ExpectedScoreCalculator::EdgeCsr
-ExpectedScoreCalculator::build_edge_csr(const Graph &graph)
+void ExpectedScoreCalculator::build_edge_csr(const Graph &graph, EdgeCsr &edge_csr)
 {
     const std::size_t vertex_count = graph.num_vertices();
     const std::size_t edge_count = graph.edges.size();
     assert(vertex_count <= std::numeric_limits<std::uint32_t>::max());
     assert(edge_count <= std::numeric_limits<std::uint32_t>::max());
 
-    EdgeCsr edge_csr;
-    edge_csr.draw_edge_offsets.assign(vertex_count + 1, 0);
-    edge_csr.selection_edge_offsets.assign(vertex_count + 1, 0);
-
+    // 次数の累積和を書き込み位置とし、辺を1回の走査で振り分ける。
+    edge_csr.draw_edge_offsets.resize(vertex_count + 1);
+    edge_csr.selection_edge_offsets.resize(vertex_count + 1);
+    edge_csr.draw_edge_offsets[0] = 0;
+    edge_csr.selection_edge_offsets[0] = 0;
     for (std::size_t vi = 0; vi < vertex_count; ++vi) {
-        for (std::uint32_t edge = graph.first_out_edges[vi]; edge != Graph::NoEdge;
-             edge = graph.edges[edge].next_out) {
-            ++edge_csr.draw_edge_offsets[vi + 1];
-        }
-        for (std::uint32_t edge = graph.first_in_edges[vi]; edge != Graph::NoEdge;
-             edge = graph.edges[edge].next_in) {
-            ++edge_csr.selection_edge_offsets[vi + 1];
-        }
+        edge_csr.draw_edge_offsets[vi + 1] =
+            edge_csr.draw_edge_offsets[vi] + graph.out_degrees[vi];
+        edge_csr.selection_edge_offsets[vi + 1] =
+            edge_csr.selection_edge_offsets[vi] + graph.in_degrees[vi];
     }
 
-    for (std::size_t vi = 0; vi < vertex_count; ++vi) {
-        edge_csr.draw_edge_offsets[vi + 1] += edge_csr.draw_edge_offsets[vi];
-        edge_csr.selection_edge_offsets[vi + 1] += edge_csr.selection_edge_offsets[vi];
-    }
-
-    edge_csr.draw_edges.resize(edge_csr.draw_edge_offsets.back());
-    edge_csr.selection_edges.resize(edge_csr.selection_edge_offsets.back());
-
-    std::vector<std::uint32_t> draw_positions = edge_csr.draw_edge_offsets;
-    std::vector<std::uint32_t> selection_positions = edge_csr.selection_edge_offsets;
+    edge_csr.draw_edges.resize(edge_count);
+    edge_csr.selection_edges.resize(edge_count);
 
-    for (std::size_t vi = 0; vi < vertex_count; ++vi) {
-        for (std::uint32_t ei = graph.first_out_edges[vi]; ei != Graph::NoEdge;
-             ei = graph.edges[ei].next_out) {
-            const EdgeData &edge = graph.edges[ei];
-            edge_csr.draw_edges[draw_positions[vi]++] =
-                DrawEdge{edge.target, edge.weight, edge.score};
-        }
-        for (std::uint32_t ei = graph.first_in_edges[vi]; ei != Graph::NoEdge;
-             ei = graph.edges[ei].next_in) {
-            const EdgeData &edge = graph.edges[ei];
-            edge_csr.selection_edges[selection_positions[vi]++] =
-                SelectionEdge{edge.source};
-        }
+    for (const EdgeData &edge : graph.edges) {
+        edge_csr.draw_edges[edge_csr.draw_edge_offsets[edge.source]++] =
+            DrawEdge{edge.target, edge.weight, edge.score};
+        edge_csr.selection_edges[edge_csr.selection_edge_offsets[edge.target]++] =
+            SelectionEdge{edge.source};
     }
 
-    return edge_csr;
+    // 書き込み位置を1つずらしてオフセットに戻す。
+    for (std::size_t vi = vertex_count; vi > 0; --vi) {
+        edge_csr.draw_edge_offsets[vi] = edge_csr.draw_edge_offsets[vi - 1];
+        edge_csr.selection_edge_offsets[vi] = edge_csr.selection_edge_offsets[vi - 1];
+    }
+    edge_csr.draw_edge_offsets[0] = 0;
+    edge_csr.selection_edge_offsets[0] = 0;
 }
 
-void ExpectedScoreCalculator::calc_stats(const Config &config, Graph &graph,
+void ExpectedScoreCalculator::calc_stats(const Config &config, const Graph &graph,
                                          const std::vector<Vertex> &draw_vertices,
                                          const std::vector<Vertex> &discard_vertices,
-                                         const EdgeCsr &edge_csr)
+                                         const EdgeCsr &edge_csr, StatTable &table)
 {
+    table.assign(graph.num_vertices());
+
     for (int t = config.t_max; t >= config.t_min; --t) {
+        // 取り消された場合、残りの巡目は計算しない。
+        if (is_cancelled(config)) {
+            return;
+        }
+
+        ValueType *tenpai_probs = table.column(StatTable::TenpaiProb, t);
+        ValueType *win_probs = table.column(StatTable::WinProb, t);
+        ValueType *exp_scores = table.column(StatTable::ExpScore, t);
+
         // draw node
-#ifdef _OPENMP
-#pragma omp parallel for schedule(static)
-#endif
-        for (std::int64_t i = 0; i < static_cast<std::int64_t>(draw_vertices.size());
-             ++i) {
-            const Vertex vertex = draw_vertices[i];
-            VertexData &s1 = graph[vertex];
-            if (t == config.t_max) {
-                if (s1.is_tenpai) {
-                    s1.tenpai_prob[t] = 1.0;
+        if (t == config.t_max) {
+            for (const Vertex vertex : draw_vertices) {
+                if (graph.is_tenpai[vertex]) {
+                    tenpai_probs[vertex] = 1.0;
                 }
-                continue;
             }
+        }
+        else {
+            const ValueType *next_tenpai_probs =
+                table.column(StatTable::TenpaiProb, t + 1);
+            const ValueType *next_win_probs = table.column(StatTable::WinProb, t + 1);
+            const ValueType *next_exp_scores = table.column(StatTable::ExpScore, t + 1);
 
-            const std::size_t vi = static_cast<std::size_t>(vertex);
-            for (std::uint32_t ei = edge_csr.draw_edge_offsets[vi];
-                 ei < edge_csr.draw_edge_offsets[vi + 1]; ++ei) {
-                const DrawEdge &edge = edge_csr.draw_edges[ei];
-                const VertexData &s2 = graph[edge.target];
-
-                double tenpai_prob = s2.tenpai_prob[t + 1];
-                double win_prob = s2.win_prob[t + 1];
-                double exp_score = s2.exp_score[t + 1];
-                if (edge.score > 0.0) {
-                    tenpai_prob = 1.0;
-                    win_prob = 1.0;
-                    exp_score = std::max(edge.score, exp_score);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+            for (std::int64_t i = 0;
+                 i < static_cast<std::int64_t>(draw_vertices.size()); ++i) {
+                const Vertex vertex = draw_vertices[i];
+                const double prev_tenpai_prob = next_tenpai_probs[vertex];
+                const double prev_win_prob = next_win_probs[vertex];
+                const double prev_exp_score = next_exp_scores[vertex];
+                double sum_tenpai_prob = 0.0;
+                double sum_win_prob = 0.0;
+                double sum_exp_score = 0.0;
+
+                const std::size_t vi = static_cast<std::size_t>(vertex);
+                for (std::uint32_t ei = edge_csr.draw_edge_offsets[vi];
+                     ei < edge_csr.draw_edge_offsets[vi + 1]; ++ei) {
+                    const DrawEdge &edge = edge_csr.draw_edges[ei];
+
+                    double tenpai_prob = next_tenpai_probs[edge.target];
+                    double win_prob = next_win_probs[edge.target];
+                    double exp_score = next_exp_scores[edge.target];
+                    if (edge.score > 0.0) {
+                        tenpai_prob = 1.0;
+                        win_prob = 1.0;
+                        exp_score = std::max(edge.score, exp_score);
+                    }
+
+                    sum_tenpai_prob += edge.weight * (tenpai_prob - prev_tenpai_prob);
+                    sum_win_prob += edge.weight * (win_prob - prev_win_prob);
+                    sum_exp_score += edge.weight * (exp_score - prev_exp_score);
                 }
 
-                s1.tenpai_prob[t] +=
-                    edge.weight * (tenpai_prob - s1.tenpai_prob[t + 1]);
-                s1.win_prob[t] += edge.weight * (win_prob - s1.win_prob[t + 1]);
-                s1.exp_score[t] += edge.weight * (exp_score - s1.exp_score[t + 1]);
+                tenpai_probs[vertex] =
+                    graph.is_tenpai[vertex]
+                        ? 1.0
+                        : prev_tenpai_prob + sum_tenpai_prob / (config.sum - t);
+                win_probs[vertex] = prev_win_prob + sum_win_prob / (config.sum - t);
+                exp_scores[vertex] = prev_exp_score + sum_exp_score / (config.sum - t);
             }
-
-            s1.tenpai_prob[t] =
-                s1.tenpai_prob[t + 1] + s1.tenpai_prob[t] / (config.sum - t);
-            if (s1.is_tenpai) {
-                s1.tenpai_prob[t] = 1.0;
-            }
-            s1.win_prob[t] = s1.win_prob[t + 1] + s1.win_prob[t] / (config.sum - t);
-            s1.exp_score[t] = s1.exp_score[t + 1] + s1.exp_score[t] / (config.sum - t);
         }
 
         // discard node
@@ -611,26 +1419,23 @@ void ExpectedScoreCalculator::calc_stats(const Config &config, Graph &graph,
         for (std::int64_t i = 0; i < static_cast<std::int64_t>(discard_vertices.size());
              ++i) {
             const Vertex vertex = discard_vertices[i];
-            VertexData &s1 = graph[vertex];
-            double best_tenpai_prob = 0.0;
-            double best_win_prob = 0.0;
-            double best_exp_score = 0.0;
+            ValueType best_tenpai_prob = 0.0;
+            ValueType best_win_prob = 0.0;
+            ValueType best_exp_score = 0.0;
 
             const std::size_t vi = static_cast<std::size_t>(vertex);
             for (std::uint32_t ei = edge_csr.selection_edge_offsets[vi];
                  ei < edge_csr.selection_edge_offsets[vi + 1]; ++ei) {
                 const SelectionEdge &edge = edge_csr.selection_edges[ei];
-                const VertexData &s2 = graph[edge.source];
-                if (s2.tenpai_prob[t] > best_tenpai_prob) {
-                    best_tenpai_prob = s2.tenpai_prob[t];
-                }
-                best_win_prob = std::max(best_win_prob, s2.win_prob[t]);
-                best_exp_score = std::max(best_exp_score, s2.exp_score[t]);
+                best_tenpai_prob =
+                    std::max(best_tenpai_prob, tenpai_probs[edge.source]);
+                best_win_prob = std::max(best_win_prob, win_probs[edge.source]);
+                best_exp_score = std::max(best_exp_score, exp_scores[edge.source]);
             }
 
-            s1.tenpai_prob[t] = best_tenpai_prob;
-            s1.win_prob[t] = best_win_prob;
-            s1.exp_score[t] = best_exp_score;
+            tenpai_probs[vertex] = best_tenpai_prob;
+            win_probs[vertex] = best_win_prob;
+            exp_scores[vertex] = best_exp_score;
         }
     }
 }
@@ -648,50 +1453,45 @@ ExpectedScoreCalculator::calc(const Config &config, const TableConfig &table_con
 
 void ExpectedScoreCalculator::calc_draw_hand(
     const Config &config, const PlayerState &player, const TableConfig &table_config,
-    const RoundState &round_state, const TableState &table_state,
-    const MergedCount &wall, const SeparatedCount &hand_counts,
-    GraphBuilder &graph_builder, std::vector<Stat> &stats)
+    const MergedCount &wall, const SeparatedCount &hand_counts, Context &context,
+    std::vector<Stat> &stats)
 {
-    // 13枚の場合は自摸を起点に手牌遷移のグラフを作成する。
-    const Vertex vertex = graph_builder.draw_node(false);
+    Symmetry symmetry;
+    const Vertex vertex = context.draw_cache.at(
+        canonical_key(context.symmetries, hand_counts, false, symmetry));
 
     // 確率、期待値を計算する。
-    const EdgeCsr edge_csr = build_edge_csr(graph_builder.graph());
-    calc_stats(config, graph_builder.graph(), graph_builder.draw_vertices(),
-               graph_builder.discard_vertices(), edge_csr);
-
-    // 結果を取得する。
-    const VertexData &state = graph_builder.graph()[vertex];
+    build_edge_csr(context.graph, context.edge_csr);
+    calc_stats(config, context.graph, context.draw_vertices, context.discard_vertices,
+               context.edge_csr, context.table);
+    const StatTable &table = context.table;
 
     // 有効牌の一覧を計算する。
     const auto [shanten2, necessary_tiles] =
         get_necessary_tiles(config, player, wall, table_config.game_mode);
 
-    stats.emplace_back(Stat{Tile::Null, to_vector(state.tenpai_prob, config.t_max),
-                            to_vector(state.win_prob, config.t_max),
-                            to_vector(state.exp_score, config.t_max), necessary_tiles,
-                            shanten2});
+    // 結果を取得する。
+    stats.emplace_back(
+        Stat{Tile::Null, table.to_vector(StatTable::TenpaiProb, vertex, config.t_max),
+             table.to_vector(StatTable::WinProb, vertex, config.t_max),
+             table.to_vector(StatTable::ExpScore, vertex, config.t_max),
+             necessary_tiles, shanten2});
 }
 
 void ExpectedScoreCalculator::calc_discard_hand(
     const Config &config, PlayerState &player, const TableConfig &table_config,
-    const RoundState &round_state, const TableState &table_state,
     const MergedCount &wall, SeparatedCount &hand_counts, SeparatedCount &wall_counts,
-    GraphBuilder &graph_builder, std::vector<Stat> &stats)
+    const HandAnalyzer::Result &analysis, Context &context, std::vector<Stat> &stats)
 {
-    // 14枚の場合は打牌を起点に手牌遷移のグラフを作成する。
-    graph_builder.discard_node(false);
-
     // 確率、期待値を計算する。
-    const EdgeCsr edge_csr = build_edge_csr(graph_builder.graph());
-    calc_stats(config, graph_builder.graph(), graph_builder.draw_vertices(),
-               graph_builder.discard_vertices(), edge_csr);
+    build_edge_csr(context.graph, context.edge_csr);
+    calc_stats(config, context.graph, context.draw_vertices, context.discard_vertices,
+               context.edge_csr, context.table);
+    const StatTable &table = context.table;
 
     // 結果を取得する。
-    auto [discard_type, discard_shanten, discard_tiles] =
-        UnnecessaryTileCalculator::calc(player.hand, player.num_melds(),
-                                        config.shanten_type, table_config.game_mode);
-    discard_tiles = add_red5_flags(discard_tiles);
+    const int discard_shanten = analysis.shanten;
+    const int64_t discard_tiles = add_red5_flags(analysis.unnecessary_tiles);
 
     for (int i = 0; i < 37; ++i) {
         if (hand_counts[i] > 0) {
@@ -700,17 +1500,23 @@ void ExpectedScoreCalculator::calc_discard_hand(
                 player.is_closed() && discard_shanten == 0 && is_disc;
 
             discard(player, hand_counts, wall_counts, i);
-            if (const auto itr =
-                    graph_builder.draw_cache().find(CacheKey(hand_counts, call_riichi));
-                itr != graph_builder.draw_cache().end()) {
-                const VertexData &state = graph_builder.graph()[itr->second];
+            Symmetry symmetry;
+            if (const auto itr = context.draw_cache.find(canonical_key(
+                    context.symmetries, hand_counts, call_riichi, symmetry));
+                itr != context.draw_cache.end()) {
+                const Vertex vertex = itr->second;
 
                 const auto [shanten2, necessary_tiles] =
                     get_necessary_tiles(config, player, wall, table_config.game_mode);
 
-                stats.emplace_back(Stat{i, to_vector(state.tenpai_prob, config.t_max),
-                                        to_vector(state.win_prob, config.t_max),
-                                        to_vector(state.exp_score, config.t_max),
+                const auto tenpai_prob =
+                    table.to_vector(StatTable::TenpaiProb, vertex, config.t_max);
+                const auto win_prob =
+                    table.to_vector(StatTable::WinProb, vertex, config.t_max);
+                const auto exp_score =
+                    table.to_vector(StatTable::ExpScore, vertex, config.t_max);
+
+                stats.emplace_back(Stat{i, tenpai_prob, win_prob, exp_score,
                                         necessary_tiles, shanten2});
             }
             draw(player, hand_counts, wall_counts, i);
@@ -719,10 +1525,59 @@ void ExpectedScoreCalculator::calc_discard_hand(
 }
 
 std::tuple<std::vector<ExpectedScoreCalculator::Stat>, int>
-ExpectedScoreCalculator::calc(const Config &_config, const TableConfig &_table_config,
-                              const RoundState &_round_state,
-                              const TableState &_table_state,
-                              const PlayerState &_player, const MergedCount &_wall)
+ExpectedScoreCalculator::calc(const Config &config, const TableConfig &table_config,
+                              const RoundState &round_state,
+                              const TableState &table_state, const PlayerState &player,
+                              const MergedCount &wall)
+{
+    Context context;
+
+    return calc(config, table_config, round_state, table_state, player, wall, context);
+}
+
+std::tuple<std::vector<ExpectedScoreCalculator::Stat>, int>
+ExpectedScoreCalculator::calc(const Config &config, const TableConfig &table_config,
+                              const RoundState &round_state,
+                              const TableState &table_state, const PlayerState &player,
+                              const MergedCount &wall, Context &context)
+{
+    return calc_impl(config, table_config, round_state, table_state, player, wall,
+                     context, nullptr);
+}
+
+/**
+ * @brief Calculate the statistics while widening the range of exchanges from 0 to
+ *        config.extra. The results of each pass are passed to the callback, and
+ *        each pass extends the graph of the previous pass instead of rebuilding it.
+ *
+ * @param[in] config configuration
+ * @param[in] table_config table configuration
+ * @param[in] round_state round state
+ * @param[in] table_state table state
+ * @param[in] player player state
+ * @param[in] wall wall
+ * @param[in] context context of the calculation
+ * @param[in] callback function called with the results of each pass
+ * @return results of the last pass and number of searched vertices
+ */
+std::tuple<std::vector<ExpectedScoreCalculator::Stat>, int>
+ExpectedScoreCalculator::calc_progressive(
+    const Config &config, const TableConfig &table_config,
+    const RoundState &round_state, const TableState &table_state,
+    const PlayerState &player, const MergedCount &wall, Context &context,
+    const ProgressCallback &callback)
+{
+    return calc_impl(config, table_config, round_state, table_state, player, wall,
+                     context, &callback);
+}
+
+std::tuple<std::vector<ExpectedScoreCalculator::Stat>, int>
+ExpectedScoreCalculator::calc_impl(const Config &_config,
+                                   const TableConfig &_table_config,
+                                   const RoundState &_round_state,
+                                   const TableState &_table_state,
+                                   const PlayerState &_player, const MergedCount &_wall,
+                                   Context &context, const ProgressCallback *callback)
 {
     Config config = _config;
     TableConfig table_config = _table_config;
@@ -746,6 +1601,8 @@ ExpectedScoreCalculator::calc(const Config &_config, const TableConfig &_table_c
     SeparatedCount hand_counts = to_separated_count(player.hand);
     SeparatedCount wall_counts = to_separated_count(wall);
     std::vector<Stat> stats;
+    context.approximate_ = false;
+    context.cancelled_ = false;
     const int num_tiles = player.num_tiles() + player.num_melds() * 3;
 
     if (!config.calc_stats) {
@@ -770,21 +1627,79 @@ ExpectedScoreCalculator::calc(const Config &_config, const TableConfig &_table_c
     }
 
     const SeparatedCount hand_org = hand_counts;
-    const int shanten_org = std::get<1>(ShantenCalculator::calc(
-        player.hand, player.num_melds(), config.shanten_type, table_config.game_mode));
+    const HandAnalyzer::Result analysis = HandAnalyzer::calc(
+        player.hand, player.num_melds(), config.shanten_type, table_config.game_mode);
+    const int shanten_org = analysis.shanten;
+    context.clear();
+    context.symmetries = find_symmetries(config, table_config, table_state, player,
+                                         hand_counts, wall_counts);
+    SearchBudget budget(config);
+
+    // 段階的に計算する場合、探索範囲を0から広げていく。
+    const int max_extra = config.extra;
+    if (callback) {
+        config.extra = std::min(config.extra, 0);
+    }
+
     GraphBuilder graph_builder(config, table_config, round_state, table_state, player,
-                               hand_counts, wall_counts, hand_org, shanten_org);
+                               hand_counts, wall_counts, hand_org, shanten_org, context,
+                               budget);
+    if (callback) {
+        graph_builder.enable_refinement();
+    }
 
+    // 13枚の場合は自摸、14枚の場合は打牌を起点に手牌遷移のグラフを作成する。
     if (num_tiles == 13) {
-        calc_draw_hand(config, player, table_config, round_state, table_state, wall,
-                       hand_counts, graph_builder, stats);
+        graph_builder.draw_node(false);
     }
     else {
-        calc_discard_hand(config, player, table_config, round_state, table_state, wall,
-                          hand_counts, wall_counts, graph_builder, stats);
+#ifdef _OPENMP
+        // 段階的に計算する場合、展開を打ち切った頂点を記録するため、並列化しない。
+        if (!callback && omp_get_max_threads() > 1) {
+            graph_builder.discard_node_parallel(context);
+        }
+        else {
+            graph_builder.discard_node(false);
+        }
+#else
+        graph_builder.discard_node(false);
+#endif
     }
 
-    const int searched = static_cast<int>(graph_builder.graph().num_vertices());
+    int searched = 0;
+    while (!budget.cancelled()) {
+        stats.clear();
+        if (num_tiles == 13) {
+            calc_draw_hand(config, player, table_config, wall, hand_counts, context,
+                           stats);
+        }
+        else {
+            calc_discard_hand(config, player, table_config, wall, hand_counts,
+                              wall_counts, analysis, context, stats);
+        }
+        searched = static_cast<int>(context.graph.num_vertices());
+
+        if (budget.cancelled() || !callback ||
+            !(*callback)(stats, searched, config.extra) ||
+            config.extra >= max_extra || budget.exceeded()) {
+            break;
+        }
+
+        // 前回のグラフを広げた探索範囲まで拡張する。
+        ++config.extra;
+        graph_builder.extend();
+    }
+
+    context.peak_memory_usage_ =
+        std::max(context.peak_memory_usage_, context.memory_usage());
+    context.approximate_ = budget.exceeded();
+
+    // 取り消された場合、途中までの結果は返さない。
+    if (budget.cancelled()) {
+        context.cancelled_ = true;
+        stats.clear();
+        return {stats, searched};
+    }
 
     return {stats, searched};
 }
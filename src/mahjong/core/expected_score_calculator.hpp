@@ -2,13 +2,17 @@
 #define MAHJONG_CPP_EXPECTED_SCORE_CALCULATOR
 
 #include <array>
+#include <atomic>
 #include <cstdint>
+#include <functional>
 #include <limits>
+#include <memory>
 #include <tuple>
 #include <vector>
 
 #include <boost/unordered/unordered_flat_map.hpp>
 
+#include "mahjong/core/hand_analyzer.hpp"
 #include "mahjong/types/types.hpp"
 
 namespace mahjong
@@ -44,6 +48,20 @@ class ExpectedScoreCalculator
         bool enable_tegawari = true;
         /* calculate value */
         bool calc_stats = true;
+        /* maximum number of vertices before only the shortest paths are searched
+           (0: unlimited) */
+        int max_vertices = 0;
+        /* time in milliseconds before only the shortest paths are searched, which
+           are searched regardless of the time (0: unlimited) */
+        int time_budget = 0;
+        /* merge the hands which are the same under the suit permutations or the
+           mirroring of numbers allowed by the wall, dora and melds */
+        bool enable_symmetry = false;
+        /* cache the uradora distributions by hand (disable to verify the cache) */
+        bool enable_uradora_cache = true;
+        /* flag set by another thread to stop the calculation (nullptr: never
+           stopped) */
+        const std::atomic<bool> *cancel = nullptr;
     };
 
     struct Stat
@@ -62,6 +80,17 @@ class ExpectedScoreCalculator
         int shanten;
     };
 
+    /**
+     * @brief Function called with the results of each pass of calc_progressive().
+     *        The search is stopped if it returns false.
+     *
+     * @param[in] stats results of the pass
+     * @param[in] searched number of searched vertices
+     * @param[in] extra range of exchanges searched by the pass
+     */
+    using ProgressCallback =
+        std::function<bool(const std::vector<Stat> &stats, int searched, int extra)>;
+
   private:
     static constexpr int MaxTurn = 18;
 
@@ -89,6 +118,37 @@ class ExpectedScoreCalculator
             return manzu == other.manzu && pinzu == other.pinzu &&
                    souzu == other.souzu && honors == other.honors;
         }
+
+        SeparatedCount hand() const
+        {
+            SeparatedCount hand{0};
+            const auto decode = [&hand](int32_t value, const int first, const int n) {
+                for (int i = first + n - 1; i >= first; --i) {
+                    hand[i] = value & 7;
+                    value >>= 3;
+                }
+            };
+            decode(manzu, 0, 9);
+            decode(pinzu, 9, 9);
+            decode(souzu, 18, 9);
+            decode(honors & 0x1fffff, 27, 7);
+            hand[Tile::RedManzu5] = (honors >> 21) & 1;
+            hand[Tile::RedPinzu5] = (honors >> 22) & 1;
+            hand[Tile::RedSouzu5] = (honors >> 23) & 1;
+            return hand;
+        }
+
+        bool riichi() const
+        {
+            return (honors >> 24) & 1;
+        }
+
+        bool operator<(const CacheKey &other) const
+        {
+            return std::tie(manzu, pinzu, souzu, honors) <
+                   std::tie(other.manzu, other.pinzu, other.souzu, other.honors);
+        }
+
         int32_t manzu;
         int32_t pinzu;
         int32_t souzu;
@@ -107,89 +167,167 @@ class ExpectedScoreCalculator
         }
     };
 
-    struct VertexData
+    /**
+     * @brief Permutation of the suits, optionally combined with the mirroring of the
+     *        numbers (1 <-> 9), which maps a hand to one with the same statistics.
+     */
+    struct Symmetry
     {
-      public:
-        VertexData() = default;
-        explicit VertexData(const bool tenpai) : is_tenpai(tenpai)
+        int map(const int tile) const
         {
+            if (tile < Tile::East) {
+                const int number = tile % 9;
+                return suits[tile / 9] * 9 + (mirror ? 8 - number : number);
+            }
+            if (tile >= Tile::RedManzu5) {
+                return Tile::RedManzu5 + suits[tile - Tile::RedManzu5];
+            }
+            return tile;
         }
 
-        std::array<double, MaxTurn + 1> tenpai_prob{};
-        std::array<double, MaxTurn + 1> win_prob{};
-        std::array<double, MaxTurn + 1> exp_score{};
-        bool is_tenpai = false;
+        /* suit to which each suit is mapped */
+        std::array<int, 3> suits = {0, 1, 2};
+        /* whether the numbers are mirrored */
+        bool mirror = false;
     };
 
     using Vertex = std::uint32_t;
 
+#ifdef USE_FLOAT_PROBABILITY
+    using ValueType = float;
+#else
+    using ValueType = double;
+#endif
+
+    /**
+     * @brief Tenpai probabilities, win probabilities and expected scores of vertices.
+     *        The values are stored turn-major, so that each turn of calc_stats()
+     *        reads and writes contiguous columns.
+     */
+    struct StatTable
+    {
+        enum Value
+        {
+            TenpaiProb,
+            WinProb,
+            ExpScore,
+            NumValues
+        };
+
+        void assign(const std::size_t num_vertices)
+        {
+            size = num_vertices;
+            for (auto &column : values) {
+                column.assign((MaxTurn + 1) * size, ValueType{0});
+            }
+        }
+
+        ValueType *column(const Value value, const int t)
+        {
+            return values[value].data() + t * size;
+        }
+
+        const ValueType *column(const Value value, const int t) const
+        {
+            return values[value].data() + t * size;
+        }
+
+        std::vector<double> to_vector(const Value value, const Vertex vertex,
+                                      const int t_max) const
+        {
+            std::vector<double> ret(t_max + 1);
+            for (int t = 0; t <= t_max; ++t) {
+                ret[t] = column(value, t)[vertex];
+            }
+            return ret;
+        }
+
+        std::size_t size = 0;
+        std::array<std::vector<ValueType>, NumValues> values;
+    };
+
     struct EdgeData
     {
         Vertex source;
         Vertex target;
-        std::uint32_t next_out;
-        std::uint32_t next_in;
         int weight;
+        std::uint8_t tile;
+        bool riichi;
         double score;
     };
 
+    /**
+     * @brief Graph of hand transitions. Edges always go from a draw node to a discard
+     *        node, which has one more tile than the draw node.
+     *        Edges are appended to a flat list while the degrees of the vertices are
+     *        counted, so that build_edge_csr() only has to scatter them.
+     */
     struct Graph
     {
-        static constexpr std::uint32_t NoEdge =
-            std::numeric_limits<std::uint32_t>::max();
-
-        Vertex add_vertex()
+        Vertex add_vertex(const bool tenpai)
         {
-            const Vertex vertex = static_cast<Vertex>(vertices.size());
-            vertices.emplace_back();
-            first_out_edges.push_back(NoEdge);
-            first_in_edges.push_back(NoEdge);
+            const Vertex vertex = static_cast<Vertex>(is_tenpai.size());
+            is_tenpai.push_back(tenpai);
+            edge_tiles.push_back({0, 0});
+            out_degrees.push_back(0);
+            in_degrees.push_back(0);
             return vertex;
         }
 
-        void add_edge(const Vertex source, const Vertex target, const int weight,
-                      const double score)
+        /**
+         * @brief Add the edge from the draw node to the discard node, which is reached
+         *        by drawing the tile. The discard node is identified by the tile and
+         *        its riichi flag.
+         */
+        void add_edge(const Vertex source, const Vertex target, const int tile,
+                      const bool riichi, const int weight, const double score)
         {
-            const auto edge = static_cast<std::uint32_t>(edges.size());
-            edges.push_back(EdgeData{source, target, first_out_edges[source],
-                                     first_in_edges[target], weight, score});
-            first_out_edges[source] = edge;
-            first_in_edges[target] = edge;
+            edge_tiles[source][riichi] |= UINT64_C(1) << tile;
+            edges.push_back(EdgeData{source, target, weight,
+                                     static_cast<std::uint8_t>(tile), riichi, score});
+            ++out_degrees[source];
+            ++in_degrees[target];
         }
 
-        bool has_edge(const Vertex source, const Vertex target) const
+        bool has_edge(const Vertex source, const int tile, const bool riichi) const
         {
-            for (std::uint32_t edge = first_out_edges[source]; edge != NoEdge;
-                 edge = edges[edge].next_out) {
-                if (edges[edge].target == target) {
-                    return true;
-                }
-            }
-            return false;
+            return edge_tiles[source][riichi] & (UINT64_C(1) << tile);
         }
 
         std::size_t num_vertices() const
         {
-            return vertices.size();
+            return is_tenpai.size();
         }
 
-        VertexData &operator[](const Vertex vertex)
+        void clear()
         {
-            return vertices[vertex];
+            is_tenpai.clear();
+            edge_tiles.clear();
+            out_degrees.clear();
+            in_degrees.clear();
+            edges.clear();
         }
 
-        const VertexData &operator[](const Vertex vertex) const
-        {
-            return vertices[vertex];
-        }
-
-        std::vector<VertexData> vertices;
+        std::vector<std::uint8_t> is_tenpai;
+        /* tiles drawn from the vertex, indexed by the riichi flag of the target */
+        std::vector<std::array<std::uint64_t, 2>> edge_tiles;
+        std::vector<std::uint32_t> out_degrees;
+        std::vector<std::uint32_t> in_degrees;
         std::vector<EdgeData> edges;
-        std::vector<std::uint32_t> first_out_edges;
-        std::vector<std::uint32_t> first_in_edges;
     };
 
     using Cache = boost::unordered_flat_map<CacheKey, Vertex, CacheKeyHash>;
+    using UradoraCache =
+        boost::unordered_flat_map<CacheKey, std::array<double, 13>, CacheKeyHash>;
+
+    /* vertex expanded by the builder of another thread */
+    struct Owner
+    {
+        std::uint32_t thread;
+        Vertex vertex;
+    };
+
+    class SharedCache;
 
     struct DrawEdge
     {
@@ -212,6 +350,69 @@ class ExpectedScoreCalculator
     };
 
   public:
+    /**
+     * @brief Buffers used by the calculation.
+     *        A context keeps the capacity of the graph, the caches and the tables
+     *        between calls, so holding one per thread avoids reallocating them for
+     *        every request. A context must not be used by two threads at once.
+     */
+    class Context
+    {
+      public:
+        std::size_t memory_usage() const;
+        std::size_t peak_memory_usage() const
+        {
+            return peak_memory_usage_;
+        }
+        /* whether the last calculation ran out of max_vertices or time_budget */
+        bool is_approximate() const
+        {
+            return approximate_;
+        }
+        /* whether the last calculation was stopped by config.cancel */
+        bool is_cancelled() const
+        {
+            return cancelled_;
+        }
+        void release();
+
+      private:
+        friend class ExpectedScoreCalculator;
+
+        void clear();
+
+        /* graph of hand transitions */
+        Graph graph;
+        /* draw nodes indexed by hand */
+        Cache draw_cache;
+        /* discard nodes indexed by hand */
+        Cache discard_cache;
+        /* list of draw nodes */
+        std::vector<Vertex> draw_vertices;
+        /* list of discard nodes */
+        std::vector<Vertex> discard_vertices;
+        /* distributions of the number of uradora indexed by hand */
+        UradoraCache uradora_cache;
+        /* edges of the graph in CSR format */
+        EdgeCsr edge_csr;
+        /* probabilities and expected scores */
+        StatTable table;
+        /* symmetries allowed in the calculation, except the identity */
+        std::vector<Symmetry> symmetries;
+        /* vertices of this context expanded in the contexts of other threads */
+        std::vector<std::pair<Vertex, Owner>> foreign_vertices;
+        /* contexts of the threads building the graph in parallel */
+        std::vector<Context> thread_contexts;
+        /* vertices claimed by the threads building the graph in parallel */
+        std::shared_ptr<SharedCache> shared_cache;
+        /* high-water mark of memory_usage() */
+        std::size_t peak_memory_usage_ = 0;
+        /* whether the search was cut short by the budget */
+        bool approximate_ = false;
+        /* whether the calculation was stopped by config.cancel */
+        bool cancelled_ = false;
+    };
+
     ExpectedScoreCalculator() = default;
 
     static std::tuple<std::vector<Stat>, int> calc(const Config &config,
@@ -227,30 +428,50 @@ class ExpectedScoreCalculator
                                                    const PlayerState &player,
                                                    const MergedCount &wall);
 
+    static std::tuple<std::vector<Stat>, int>
+    calc(const Config &config, const TableConfig &table_config,
+         const RoundState &round_state, const TableState &table_state,
+         const PlayerState &player, const MergedCount &wall, Context &context);
+
+    static std::tuple<std::vector<Stat>, int>
+    calc_progressive(const Config &config, const TableConfig &table_config,
+                     const RoundState &round_state, const TableState &table_state,
+                     const PlayerState &player, const MergedCount &wall,
+                     Context &context, const ProgressCallback &callback);
+
   private:
     class GraphBuilder;
 
+    static std::tuple<std::vector<Stat>, int>
+    calc_impl(const Config &config, const TableConfig &table_config,
+              const RoundState &round_state, const TableState &table_state,
+              const PlayerState &player, const MergedCount &wall, Context &context,
+              const ProgressCallback *callback);
     static void calc_draw_hand(const Config &config, const PlayerState &player,
                                const TableConfig &table_config,
-                               const RoundState &round_state,
-                               const TableState &table_state,
                                const MergedCount &wall,
-                               const SeparatedCount &hand_counts,
-                               GraphBuilder &graph_builder, std::vector<Stat> &stats);
+                               const SeparatedCount &hand_counts, Context &context,
+                               std::vector<Stat> &stats);
     static void calc_discard_hand(const Config &config, PlayerState &player,
                                   const TableConfig &table_config,
-                                  const RoundState &round_state,
-                                  const TableState &table_state,
                                   const MergedCount &wall,
                                   SeparatedCount &hand_counts,
                                   SeparatedCount &wall_counts,
-                                  GraphBuilder &graph_builder,
-                                  std::vector<Stat> &stats);
-    static EdgeCsr build_edge_csr(const Graph &graph);
-    static void calc_stats(const Config &config, Graph &graph,
+                                  const HandAnalyzer::Result &analysis,
+                                  Context &context, std::vector<Stat> &stats);
+    static std::vector<Symmetry>
+    find_symmetries(const Config &config, const TableConfig &table_config,
+                    const TableState &table_state, const PlayerState &player,
+                    const SeparatedCount &hand_counts,
+                    const SeparatedCount &wall_counts);
+    static CacheKey canonical_key(const std::vector<Symmetry> &symmetries,
+                                  const SeparatedCount &hand, bool riichi,
+                                  Symmetry &symmetry);
+    static void build_edge_csr(const Graph &graph, EdgeCsr &edge_csr);
+    static void calc_stats(const Config &config, const Graph &graph,
                            const std::vector<Vertex> &draw_vertices,
                            const std::vector<Vertex> &discard_vertices,
-                           const EdgeCsr &edge_csr);
+                           const EdgeCsr &edge_csr, StatTable &table);
 };
 } // namespace mahjong
 
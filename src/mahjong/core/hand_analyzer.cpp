@@ -0,0 +1,357 @@
+#include "hand_analyzer.hpp"
+
+#include <algorithm> // max, any_of
+#include <numeric>   // accumulate
+#include <stdexcept> // invalid_argument
+
+#include <spdlog/spdlog.h>
+
+#include "mahjong/core/string.hpp"
+#include "mahjong/core/utils.hpp"
+
+namespace mahjong
+{
+
+/**
+ * @brief Calculate the shanten numbers, the necessary tiles and the unnecessary tiles.
+ *
+ * @param[in] hand hand
+ * @param[in] num_melds number of melds
+ * @param[in] type shanten number type
+ * @param[in] game_mode Mahjong game mode
+ * @return result of the analysis
+ */
+HandAnalyzer::Result HandAnalyzer::calc(const Hand &hand, const int num_melds,
+                                        const int type, const int game_mode)
+{
+#ifdef CHECK_ARGUMENTS
+    int num_tiles = std::accumulate(hand.begin(), hand.end(), 0) + num_melds * 3;
+    bool is_valid_count =
+        std::any_of(hand.begin(), hand.end(), [](int x) { return x < 0 || x > 4; });
+    if (num_tiles % 3 == 0 || num_tiles > 14 || is_valid_count) {
+        throw std::invalid_argument(fmt::format(u8"Invalid hand {} passed. {} {}",
+                                                to_mpsz(hand), num_tiles, num_melds));
+    }
+
+    if (num_melds < 0 || num_melds > 4) {
+        throw std::invalid_argument(
+            fmt::format(u8"Invalid num_melds {} passed.", num_melds));
+    }
+
+    if (type < 0 || type > 7) {
+        throw std::invalid_argument(fmt::format(u8"Invalid type {} passed.", type));
+    }
+
+    if (game_mode == GameMode::Sanma && has_sanma_disabled_tiles(hand)) {
+        throw std::invalid_argument(
+            fmt::format(u8"Invalid Sanma hand {} passed.", to_mpsz(hand)));
+    }
+#endif // CHECK_ARGUMENTS
+
+    Result ret;
+
+    if (type & ShantenFlag::StandardHand) {
+        const auto [shanten, wait, disc] =
+            game_mode == GameMode::Sanma
+                ? calc_regular<GameMode::Sanma>(hand, num_melds)
+                : calc_regular<GameMode::Yonma>(hand, num_melds);
+        ret.regular_shanten = shanten;
+        merge(ret, ShantenFlag::StandardHand, shanten, wait, disc);
+    }
+
+    if ((type & ShantenFlag::SevenPairs) && num_melds == 0) {
+        const auto [shanten, wait, disc] =
+            game_mode == GameMode::Sanma ? calc_seven_pairs<GameMode::Sanma>(hand)
+                                         : calc_seven_pairs<GameMode::Yonma>(hand);
+        ret.seven_pairs_shanten = shanten;
+        merge(ret, ShantenFlag::SevenPairs, shanten, wait, disc);
+    }
+
+    if ((type & ShantenFlag::ThirteenOrphans) && num_melds == 0) {
+        const auto [shanten, wait, disc] = calc_thirteen_orphans(hand);
+        ret.thirteen_orphans_shanten = shanten;
+        merge(ret, ShantenFlag::ThirteenOrphans, shanten, wait, disc);
+    }
+
+    return ret;
+}
+
+/**
+ * @brief Calculate the necessary tiles and the unnecessary tiles for regular hand.
+ *
+ * @param[in] hand hand
+ * @param[in] num_melds number of melds
+ * @return (shanten number, necessary tiles, unnecessary tiles)
+ */
+template <int Mode>
+std::tuple<int, int64_t, int64_t> HandAnalyzer::calc_regular(const Hand &hand,
+                                                             const int num_melds)
+{
+    const Table::TableType *manzu_ptr;
+    if constexpr (Mode == GameMode::Sanma) {
+        manzu_ptr = &Table::sanma_manzu_table_[Table::sanma_manzu_hash(
+            hand[Tile::Manzu1], hand[Tile::Manzu9])];
+    }
+    else {
+        manzu_ptr =
+            &Table::suits_table_[Table::suits_hash(hand.begin(), hand.begin() + 9)];
+    }
+    Table::HashType pinzu_hash = Table::suits_hash(hand.begin() + 9, hand.begin() + 18);
+    Table::HashType souzu_hash =
+        Table::suits_hash(hand.begin() + 18, hand.begin() + 27);
+    Table::HashType honors_hash =
+        Table::honors_hash(hand.begin() + 27, hand.begin() + 34);
+    const auto &manzu = *manzu_ptr;
+    const auto &pinzu = Table::suits_table_[pinzu_hash];
+    const auto &souzu = Table::suits_table_[souzu_hash];
+    const auto &honors = Table::honors_table_[honors_hash];
+
+    int m = 4 - num_melds;
+
+    ResultType ret;
+    init(ret, honors);
+    add1(ret, souzu, m);
+    add1(ret, pinzu, m);
+    add2(ret, manzu, m);
+
+    int shanten = static_cast<int>(ret[5 + m]) - 1;
+
+    return {shanten, ret[15 + m], ret[25 + m]};
+}
+
+/**
+ * @brief Calculate the necessary tiles and the unnecessary tiles for Seven Pairs.
+ *
+ * @param[in] hand hand
+ * @return (shanten number, necessary tiles, unnecessary tiles)
+ */
+template <int Mode>
+std::tuple<int, int64_t, int64_t> HandAnalyzer::calc_seven_pairs(const Hand &hand)
+{
+    int num_pairs = 0;
+    int num_types = 0;
+    int64_t count0_flag = 0;
+    int64_t count1_flag = 0;
+    int64_t countge3_flag = 0;
+
+    for (int i = 0; i < 34; ++i) {
+        if constexpr (Mode == GameMode::Sanma) {
+            if (Tile::is_sanma_disabled(i)) {
+                continue;
+            }
+        }
+        if (hand[i] == 0) {
+            count0_flag |= INT64_C(1) << i;
+        }
+        else if (hand[i] == 1) {
+            ++num_types;
+            count1_flag |= INT64_C(1) << i;
+        }
+        else if (hand[i] == 2) {
+            ++num_pairs;
+            ++num_types;
+        }
+        else if (hand[i] >= 3) {
+            ++num_pairs;
+            ++num_types;
+            countge3_flag |= INT64_C(1) << i;
+        }
+    }
+
+    int shanten = 6 - num_pairs + std::max(0, 7 - num_types);
+
+    int64_t wait;
+    if (num_types < 7) {
+        wait = count0_flag | count1_flag;
+    }
+    else if (num_pairs == 7) {
+        wait = 0;
+    }
+    else {
+        wait = count1_flag;
+    }
+
+    int64_t disc = num_types > 7 ? count1_flag | countge3_flag : countge3_flag;
+
+    return {shanten, wait, disc};
+}
+
+/**
+ * @brief Calculate the necessary tiles and the unnecessary tiles for Thirteen Orphans.
+ *
+ * @param[in] hand hand
+ * @return (shanten number, necessary tiles, unnecessary tiles)
+ */
+std::tuple<int, int64_t, int64_t> HandAnalyzer::calc_thirteen_orphans(const Hand &hand)
+{
+    static const auto tanyao_tiles = {
+        Tile::Manzu2, Tile::Manzu3, Tile::Manzu4, Tile::Manzu5, Tile::Manzu6,
+        Tile::Manzu7, Tile::Manzu8, Tile::Pinzu2, Tile::Pinzu3, Tile::Pinzu4,
+        Tile::Pinzu5, Tile::Pinzu6, Tile::Pinzu7, Tile::Pinzu8, Tile::Souzu2,
+        Tile::Souzu3, Tile::Souzu4, Tile::Souzu5, Tile::Souzu6, Tile::Souzu7,
+        Tile::Souzu8};
+    static const auto yaochuu_tiles = {
+        Tile::Manzu1,   Tile::Manzu9, Tile::Pinzu1,      Tile::Pinzu9,
+        Tile::Souzu1,   Tile::Souzu9, Tile::East,        Tile::South,
+        Tile::West,     Tile::North,  Tile::WhiteDragon, Tile::GreenDragon,
+        Tile::RedDragon};
+
+    int num_pairs = 0;
+    int num_types = 0;
+    int64_t tanyao_flag = 0;
+    int64_t count0_flag = 0;
+    int64_t count1_flag = 0;
+    int64_t count2_flag = 0;
+    int64_t countgt2_flag = 0;
+
+    for (const int i : tanyao_tiles) {
+        if (hand[i]) {
+            tanyao_flag |= INT64_C(1) << i;
+        }
+    }
+
+    for (int i : yaochuu_tiles) {
+        if (hand[i] == 0) {
+            count0_flag |= INT64_C(1) << i;
+        }
+        else if (hand[i] == 1) {
+            count1_flag |= INT64_C(1) << i;
+            ++num_types;
+        }
+        else if (hand[i] == 2) {
+            count2_flag |= INT64_C(1) << i;
+            ++num_types;
+            ++num_pairs;
+        }
+        else {
+            countgt2_flag |= INT64_C(1) << i;
+            ++num_types;
+            ++num_pairs;
+        }
+    }
+
+    int shanten = 13 - num_types - bool(num_pairs);
+    int64_t wait = num_pairs ? count0_flag : count0_flag | count1_flag;
+    int64_t disc = num_pairs >= 2 ? tanyao_flag | countgt2_flag | count2_flag
+                                  : tanyao_flag | countgt2_flag;
+
+    return {shanten, wait, disc};
+}
+
+// Used by IncrementalTileCalculator.
+template std::tuple<int, int64_t, int64_t>
+HandAnalyzer::calc_seven_pairs<GameMode::Yonma>(const Hand &hand);
+template std::tuple<int, int64_t, int64_t>
+HandAnalyzer::calc_seven_pairs<GameMode::Sanma>(const Hand &hand);
+
+void HandAnalyzer::merge(Result &ret, const int type, const int shanten,
+                         const int64_t wait, const int64_t disc)
+{
+    if (shanten < ret.shanten) {
+        ret.type = type;
+        ret.shanten = shanten;
+        ret.necessary_tiles = wait;
+        ret.unnecessary_tiles = disc;
+    }
+    else if (shanten == ret.shanten) {
+        ret.type |= type;
+        ret.necessary_tiles |= wait;
+        ret.unnecessary_tiles |= disc;
+    }
+}
+
+void HandAnalyzer::init(ResultType &lhs, const Table::TableType &rhs)
+{
+    for (int i = 0; i < 10; ++i) {
+        lhs[i] = Table::distance(rhs, i);
+        lhs[i + 10] = Table::wait(rhs, i);
+        lhs[i + 20] = Table::discard(rhs, i);
+    }
+}
+
+void HandAnalyzer::add1(ResultType &lhs, const Table::TableType &rhs, const int m)
+{
+    auto lhs2 = &lhs[10];
+    auto lhs3 = &lhs[20];
+
+    for (int i = m + 5; i >= 5; --i) {
+        ResultType::value_type dist = lhs[i] + Table::distance(rhs, 0);
+        ResultType::value_type wait = (lhs2[i] << 9) | Table::wait(rhs, 0);
+        ResultType::value_type disc = (lhs3[i] << 9) | Table::discard(rhs, 0);
+        shift(dist, lhs[0] + Table::distance(rhs, i), wait,
+              (lhs2[0] << 9) | Table::wait(rhs, i), disc,
+              (lhs3[0] << 9) | Table::discard(rhs, i));
+
+        for (int j = 5; j < i; ++j) {
+            shift(dist, lhs[j] + Table::distance(rhs, i - j), wait,
+                  (lhs2[j] << 9) | Table::wait(rhs, i - j), disc,
+                  (lhs3[j] << 9) | Table::discard(rhs, i - j));
+            shift(dist, lhs[i - j] + Table::distance(rhs, j), wait,
+                  (lhs2[i - j] << 9) | Table::wait(rhs, j), disc,
+                  (lhs3[i - j] << 9) | Table::discard(rhs, j));
+        }
+
+        lhs[i] = dist;
+        lhs2[i] = wait;
+        lhs3[i] = disc;
+    }
+
+    for (int i = m; i >= 0; --i) {
+        ResultType::value_type dist = lhs[i] + Table::distance(rhs, 0);
+        ResultType::value_type wait = (lhs2[i] << 9) | Table::wait(rhs, 0);
+        ResultType::value_type disc = (lhs3[i] << 9) | Table::discard(rhs, 0);
+
+        for (int j = 0; j < i; ++j) {
+            shift(dist, lhs[j] + Table::distance(rhs, i - j), wait,
+                  (lhs2[j] << 9) | Table::wait(rhs, i - j), disc,
+                  (lhs3[j] << 9) | Table::discard(rhs, i - j));
+        }
+
+        lhs[i] = dist;
+        lhs2[i] = wait;
+        lhs3[i] = disc;
+    }
+}
+
+void HandAnalyzer::add2(ResultType &lhs, const Table::TableType &rhs, const int m)
+{
+    auto lhs2 = &lhs[10];
+    auto lhs3 = &lhs[20];
+
+    int i = m + 5;
+    ResultType::value_type dist = lhs[i] + Table::distance(rhs, 0);
+    ResultType::value_type wait = (lhs2[i] << 9) | Table::wait(rhs, 0);
+    ResultType::value_type disc = (lhs3[i] << 9) | Table::discard(rhs, 0);
+    shift(dist, lhs[0] + Table::distance(rhs, i), wait,
+          (lhs2[0] << 9) | Table::wait(rhs, i), disc,
+          (lhs3[0] << 9) | Table::discard(rhs, i));
+    for (int j = 5; j < i; ++j) {
+        shift(dist, lhs[j] + Table::distance(rhs, i - j), wait,
+              (lhs2[j] << 9) | Table::wait(rhs, i - j), disc,
+              (lhs3[j] << 9) | Table::discard(rhs, i - j));
+        shift(dist, lhs[i - j] + Table::distance(rhs, j), wait,
+              (lhs2[i - j] << 9) | Table::wait(rhs, j), disc,
+              (lhs3[i - j] << 9) | Table::discard(rhs, j));
+    }
+
+    lhs[i] = dist;
+    lhs2[i] = wait;
+    lhs3[i] = disc;
+}
+
+void HandAnalyzer::shift(ResultType::value_type &lv, const ResultType::value_type rv,
+                         ResultType::value_type &lw, const ResultType::value_type rw,
+                         ResultType::value_type &ld, const ResultType::value_type rd)
+{
+    if (lv == rv) {
+        lw |= rw;
+        ld |= rd;
+    }
+    else if (lv > rv) {
+        lv = rv;
+        lw = rw;
+        ld = rd;
+    }
+}
+
+} // namespace mahjong
@@ -0,0 +1,67 @@
+#ifndef MAHJONG_CPP_HAND_ANALYZER
+#define MAHJONG_CPP_HAND_ANALYZER
+
+#include <array>
+#include <cstdint>
+#include <tuple>
+
+#include "mahjong/core/table.hpp"
+#include "mahjong/types/types.hpp"
+
+namespace mahjong
+{
+
+/**
+ * @brief The HandAnalyzer class calculates the shanten numbers, the necessary tiles
+ *        and the unnecessary tiles of a hand at once.
+ *        Each table entry carries distance, wait and discard, so the tables are
+ *        looked up and combined only once.
+ */
+class HandAnalyzer
+{
+    // Elements [0, 10) are distances, [10, 20) are waits and [20, 30) are discards.
+    using ResultType = std::array<int64_t, 30>;
+
+  public:
+    struct Result
+    {
+        /* shanten flag of the minimum shanten number */
+        int type = ShantenFlag::None;
+        /* minimum shanten number */
+        int shanten = 100;
+        /* shanten number of standard hand */
+        int regular_shanten = 100;
+        /* shanten number of Seven Pairs */
+        int seven_pairs_shanten = 100;
+        /* shanten number of Thirteen Orphans */
+        int thirteen_orphans_shanten = 100;
+        /* necessary tiles of the minimum shanten number */
+        int64_t necessary_tiles = 0;
+        /* unnecessary tiles of the minimum shanten number */
+        int64_t unnecessary_tiles = 0;
+    };
+
+    static Result calc(const Hand &hand, const int num_melds, const int type,
+                       int game_mode);
+
+  private:
+    friend class IncrementalTileCalculator;
+
+    template <int Mode>
+    static std::tuple<int, int64_t, int64_t> calc_regular(const Hand &hand,
+                                                          const int num_melds);
+    template <int Mode>
+    static std::tuple<int, int64_t, int64_t> calc_seven_pairs(const Hand &hand);
+    static std::tuple<int, int64_t, int64_t> calc_thirteen_orphans(const Hand &hand);
+    static void merge(Result &ret, int type, int shanten, int64_t wait, int64_t disc);
+    static void init(ResultType &lhs, const Table::TableType &rhs);
+    static void add1(ResultType &lhs, const Table::TableType &rhs, const int m);
+    static void add2(ResultType &lhs, const Table::TableType &rhs, const int m);
+    static void shift(ResultType::value_type &lv, const ResultType::value_type rv,
+                      ResultType::value_type &lw, const ResultType::value_type rw,
+                      ResultType::value_type &ld, const ResultType::value_type rd);
+};
+
+} // namespace mahjong
+
+#endif /* MAHJONG_CPP_HAND_ANALYZER */
@@ -1,326 +1,395 @@
-#include "hand_separator.hpp"
-
-#include <boost/dll.hpp>
-#include <rapidjson/document.h>
-#include <rapidjson/filereadstream.h>
-#include <rapidjson/writer.h>
-#include <spdlog/spdlog.h>
-
-#include <cstdio>
-#include <fstream>
-
-#include "mahjong/core/utils.hpp"
-
-namespace mahjong
-{
-
-HandSeparator::HandSeparator()
-{
-    initialize();
-}
-
-/**
- * @brief 初期化する。
- *
- * @return 初期化に成功した場合は true、そうでない場合は false を返す。
- */
-bool HandSeparator::initialize()
-{
-    if (!s_tbl_.empty())
-        return true; // 初期化済み
-
-    boost::filesystem::path s_tbl_path =
-        boost::dll::program_location().parent_path() / "suits_patterns.json";
-    boost::filesystem::path z_tbl_path =
-        boost::dll::program_location().parent_path() / "honors_patterns.json";
-
-    return make_table(s_tbl_path.string(), s_tbl_) &&
-           make_table(z_tbl_path.string(), z_tbl_);
-}
-
-/**
- * @brief 手牌の可能なブロック構成パターンを生成する。
- *
- * @param[in] hand 手牌
- * @param[in] win_tile 和了牌
- * @param[in] tsumo 自摸かどうか
- * @return std::vector<std::vector<Block>> 面子構成の一覧
- */
-std::vector<std::tuple<std::vector<Block>, int>>
-HandSeparator::separate(const PlayerState &player, const int win_tile, const int win_flag)
-{
-    std::vector<std::tuple<std::vector<Block>, int>> pattern;
-    std::vector<Block> blocks(5);
-    int i = 0;
-
-    // 副露ブロックをブロック一覧に追加する。
-    for (const auto &melded_block : player.melds) {
-        if (melded_block.type == MeldType::Pon)
-            blocks[i].type = BlockType::Triplet | BlockType::Open;
-        else if (melded_block.type == MeldType::Chi)
-            blocks[i].type = BlockType::Sequence | BlockType::Open;
-        else if (melded_block.type == MeldType::Ankan)
-            blocks[i].type = BlockType::Kan;
-        else // 明槓、加槓
-            blocks[i].type = BlockType::Kan | BlockType::Open;
-        blocks[i].min_tile = Tile::to_normal(melded_block.tiles.front());
-
-        ++i;
-    }
-
-    const int manzu_hash = std::accumulate(player.hand.begin(), player.hand.begin() + 9,
-                                           0, [](int x, int y) { return x * 8 + y; });
-    const int pinzu_hash =
-        std::accumulate(player.hand.begin() + 9, player.hand.begin() + 18, 0,
-                        [](int x, int y) { return x * 8 + y; });
-    const int souzu_hash =
-        std::accumulate(player.hand.begin() + 18, player.hand.begin() + 27, 0,
-                        [](int x, int y) { return x * 8 + y; });
-    const int honors_hash =
-        std::accumulate(player.hand.begin() + 27, player.hand.begin() + 34, 0,
-                        [](int x, int y) { return x * 8 + y; });
-
-    const std::vector<std::vector<Block>> &manzu = s_tbl_[manzu_hash];
-    const std::vector<std::vector<Block>> &pinzu = s_tbl_[pinzu_hash];
-    const std::vector<std::vector<Block>> &souzu = s_tbl_[souzu_hash];
-    const std::vector<std::vector<Block>> &honors = z_tbl_[honors_hash];
-
-    // 手牌の切り分けパターンを列挙する。
-    const int nored_win_tile = Tile::to_normal(win_tile);
-    create_block_patterns(nored_win_tile, win_flag & WinFlag::Tsumo, pattern, blocks, i,
-                          0, manzu, pinzu, souzu, honors);
-
-    return pattern;
-}
-
-/**
- * @brief 初期化する。
- *
- * @param[in] path パス
- * @param[out] table テーブル
- * @return 初期化に成功した場合は true、そうでない場合は false を返す。
- */
-bool HandSeparator::make_table(const std::string &path,
-                               std::map<int, std::vector<std::vector<Block>>> &table)
-{
-    table.clear();
-
-    std::FILE *fp = std::fopen(path.c_str(), "rb");
-    if (!fp) {
-        spdlog::error(u8"Failed to open {}.", path);
-        return false;
-    }
-
-    char *buffer = new char[1000000];
-    rapidjson::FileReadStream is(fp, buffer, sizeof(buffer));
-    rapidjson::Document doc;
-    doc.ParseStream(is);
-    if (doc.HasParseError()) {
-        spdlog::error(u8"Failed to parse {}.", path);
-        return false;
-    }
-
-    for (auto &v : doc.GetArray()) {
-        int key = v["key"].GetInt();
-
-        std::vector<std::vector<Block>> pattern;
-        for (auto &v2 : v["pattern"].GetArray())
-            pattern.push_back(get_blocks(v2.GetString()));
-
-        table[key] = pattern;
-    }
-
-    fclose(fp);
-    delete buffer;
-
-    return true;
-}
-
-std::vector<Block> HandSeparator::get_blocks(const std::string &s)
-{
-    std::vector<Block> blocks;
-
-    size_t len = s.size();
-    for (size_t i = 0; i < len; i += 2) {
-        Block block;
-        block.min_tile = s[i] - '0';
-        if (s[i + 1] == 'k')
-            block.type = BlockType::Triplet;
-        else if (s[i + 1] == 's')
-            block.type = BlockType::Sequence;
-        else if (s[i + 1] == 'z')
-            block.type = BlockType::Pair;
-
-        blocks.emplace_back(block);
-    }
-
-    return blocks;
-}
-
-/**
- * @brief 役満かどうかを判定する。
- *
- * @param[in] hand 手牌
- * @param[in] win_tile 和了牌
- * @param[in] flag 成立フラグ
- * @param[in] syanten_type 和了形の種類
- * @return YakuFlags 成立した役一覧
- */
-void HandSeparator::create_block_patterns(
-    const int win_tile, const bool tsumo,
-    std::vector<std::tuple<std::vector<Block>, int>> &pattern,
-    std::vector<Block> &blocks, size_t i, int d,
-    const std::vector<std::vector<Block>> &manzu,
-    const std::vector<std::vector<Block>> &pinzu,
-    const std::vector<std::vector<Block>> &souzu,
-    const std::vector<std::vector<Block>> &honors)
-{
-    if (d == 4) {
-        for (auto &block : blocks) {
-            if (block.type & BlockType::Open)
-                continue; // 副露ブロックは固定
-
-            if ((block.type & BlockType::Triplet) && block.min_tile == win_tile) {
-                // 双ポン待ち
-                if (tsumo) {
-                    pattern.emplace_back(blocks, WaitType::DoublePairWait);
-                }
-                else {
-                    block.type |= BlockType::Open;
-                    pattern.emplace_back(blocks, WaitType::DoublePairWait);
-                    block.type &= ~BlockType::Open;
-                }
-            }
-            else if (block.type == BlockType::Sequence &&
-                     block.min_tile + 1 == win_tile) {
-                // 嵌張待ち
-                if (tsumo) {
-                    pattern.emplace_back(blocks, WaitType::MiddleWait);
-                }
-                else {
-                    block.type |= BlockType::Open;
-                    pattern.emplace_back(blocks, WaitType::MiddleWait);
-                    block.type &= ~BlockType::Open;
-                }
-            }
-            else if (block.type == BlockType::Sequence &&
-                     block.min_tile + 2 == win_tile &&
-                     (block.min_tile == Tile::Manzu1 ||
-                      block.min_tile == Tile::Pinzu1 ||
-                      block.min_tile == Tile::Souzu1)) {
-                // 辺張待ち 123
-                if (tsumo) {
-                    pattern.emplace_back(blocks, WaitType::EdgeWait);
-                }
-                else {
-                    block.type |= BlockType::Open;
-                    pattern.emplace_back(blocks, WaitType::EdgeWait);
-                    block.type &= ~BlockType::Open;
-                }
-            }
-            else if (block.type == BlockType::Sequence && block.min_tile == win_tile &&
-                     (block.min_tile == Tile::Manzu7 ||
-                      block.min_tile == Tile::Pinzu7 ||
-                      block.min_tile == Tile::Souzu7)) {
-                // 辺張待ち 789
-                if (tsumo) {
-                    pattern.emplace_back(blocks, WaitType::EdgeWait);
-                }
-                else {
-                    block.type |= BlockType::Open;
-                    pattern.emplace_back(blocks, WaitType::EdgeWait);
-                    block.type &= ~BlockType::Open;
-                }
-            }
-            else if (block.type == BlockType::Sequence &&
-                     (block.min_tile == win_tile || block.min_tile + 2 == win_tile)) {
-                // 両面待ち
-                if (tsumo) {
-                    pattern.emplace_back(blocks, WaitType::TwoSidedWait);
-                }
-                else {
-                    block.type |= BlockType::Open;
-                    pattern.emplace_back(blocks, WaitType::TwoSidedWait);
-                    block.type &= ~BlockType::Open;
-                }
-            }
-            else if (block.type == BlockType::Pair && block.min_tile == win_tile) {
-                // 双ポン待ち
-                if (tsumo) {
-                    pattern.emplace_back(blocks, WaitType::SingleTileWait);
-                }
-                else {
-                    block.type |= BlockType::Open;
-                    pattern.emplace_back(blocks, WaitType::SingleTileWait);
-                    block.type &= ~BlockType::Open;
-                }
-            }
-        }
-
-        return;
-    }
-
-    if (d == 0) {
-        // 萬子の面子構成
-        if (manzu.empty())
-            create_block_patterns(win_tile, tsumo, pattern, blocks, i, d + 1, manzu,
-                                  pinzu, souzu, honors);
-
-        for (const auto &manzu_pattern : manzu) {
-            for (const auto &block : manzu_pattern)
-                blocks[i++] = block;
-            create_block_patterns(win_tile, tsumo, pattern, blocks, i, d + 1, manzu,
-                                  pinzu, souzu, honors);
-            i -= manzu_pattern.size();
-        }
-    }
-    else if (d == 1) {
-        // 筒子の面子構成
-        if (pinzu.empty())
-            create_block_patterns(win_tile, tsumo, pattern, blocks, i, d + 1, manzu,
-                                  pinzu, souzu, honors);
-
-        for (const auto &pinzu_pattern : pinzu) {
-            for (const auto &block : pinzu_pattern)
-                blocks[i++] = {block.type, block.min_tile + 9};
-
-            create_block_patterns(win_tile, tsumo, pattern, blocks, i, d + 1, manzu,
-                                  pinzu, souzu, honors);
-            i -= pinzu_pattern.size();
-        }
-    }
-    else if (d == 2) {
-        // 索子の面子構成
-        if (souzu.empty())
-            create_block_patterns(win_tile, tsumo, pattern, blocks, i, d + 1, manzu,
-                                  pinzu, souzu, honors);
-
-        for (const auto &sozu_pattern : souzu) {
-            for (const auto &block : sozu_pattern)
-                blocks[i++] = {block.type, block.min_tile + 18};
-            create_block_patterns(win_tile, tsumo, pattern, blocks, i, d + 1, manzu,
-                                  pinzu, souzu, honors);
-            i -= sozu_pattern.size();
-        }
-    }
-    else if (d == 3) {
-        // 字牌の面子構成
-        if (honors.empty())
-            create_block_patterns(win_tile, tsumo, pattern, blocks, i, d + 1, manzu,
-                                  pinzu, souzu, honors);
-
-        for (const auto &zihai_pattern : honors) {
-            for (const auto &block : zihai_pattern)
-                blocks[i++] = {block.type, block.min_tile + 27};
-            create_block_patterns(win_tile, tsumo, pattern, blocks, i, d + 1, manzu,
-                                  pinzu, souzu, honors);
-            i -= zihai_pattern.size();
-        }
-    }
-}
-
-std::map<int, std::vector<std::vector<Block>>> HandSeparator::s_tbl_;
-std::map<int, std::vector<std::vector<Block>>> HandSeparator::z_tbl_;
-static HandSeparator inst;
-
-} // namespace mahjong
+#include "hand_separator.hpp"
+
+#include <boost/dll.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <rapidjson/document.h>
+#include <rapidjson/filereadstream.h>
+#include <spdlog/spdlog.h>
+
+#include <cstdio>
+#include <cstring> // memcpy
+#include <map>
+
+#include "mahjong/core/utils.hpp"
+
+namespace mahjong
+{
+
+namespace
+{
+
+// マップしたテーブルファイルの領域 (テーブルより長く生存する必要がある。)
+std::vector<boost::interprocess::mapped_region> mapped_regions;
+
+// JSON ファイルから作成したテーブル
+HandSeparator::PatternTableStorage suits_table_storage;
+HandSeparator::PatternTableStorage honors_table_storage;
+
+} // namespace
+
+HandSeparator::HandSeparator()
+{
+    initialize();
+}
+
+/**
+ * @brief 初期化する。
+ *        テーブルファイル (*.map) があればマップし、
+ *        なければ JSON ファイルからテーブルを作成する。
+ *
+ * @return 初期化に成功した場合は true、そうでない場合は false を返す。
+ */
+bool HandSeparator::initialize()
+{
+    if (suits_table_.pattern_offsets && honors_table_.pattern_offsets)
+        return true; // 初期化済み
+
+    const boost::filesystem::path exe_path =
+        boost::dll::program_location().parent_path();
+
+    const auto load = [&](const std::string &name, const size_t table_size,
+                          PatternTableStorage &storage, PatternTable &table) {
+        const boost::filesystem::path mapped_path = exe_path / (name + ".map");
+        if (boost::filesystem::exists(mapped_path) &&
+            map_table(mapped_path.string(), table_size, table))
+            return true;
+
+        const boost::filesystem::path path = exe_path / (name + ".json");
+        return make_table(path.string(), table_size, storage, table);
+    };
+
+    return load("suits_patterns", SuitsTableSize, suits_table_storage, suits_table_) &&
+           load("honors_patterns", HonorsTableSize, honors_table_storage,
+                honors_table_);
+}
+
+/**
+ * @brief 手牌の可能なブロック構成パターンを生成する。
+ *
+ * @param[in] player プレイヤーの状態
+ * @param[in] win_tile 和了牌
+ * @param[in] win_flag 和了フラグ
+ * @return 面子構成と待ちの種類の一覧
+ */
+std::vector<std::tuple<std::vector<Block>, int>>
+HandSeparator::separate(const PlayerState &player, const int win_tile,
+                        const int win_flag)
+{
+    std::vector<std::tuple<std::vector<Block>, int>> pattern;
+    enumerate(player, win_tile, win_flag,
+              [&pattern](const std::array<Block, 5> &blocks, const int wait_type) {
+                  pattern.emplace_back(std::vector<Block>(blocks.begin(), blocks.end()),
+                                       wait_type);
+              });
+
+    return pattern;
+}
+
+/**
+ * @brief 副露ブロックと牌の種類ごとの面子パターンの範囲を取得する。
+ *
+ * @param[in] player プレイヤーの状態
+ * @param[out] blocks 副露ブロック
+ * @param[out] ranges 牌の種類ごとの面子パターンの範囲
+ * @return 副露ブロックの数
+ */
+size_t HandSeparator::init_patterns(const PlayerState &player,
+                                    std::array<Block, 5> &blocks,
+                                    std::array<PatternRange, 4> &ranges)
+{
+    size_t i = 0;
+
+    // 副露ブロックをブロック一覧に追加する。
+    for (const auto &melded_block : player.melds) {
+        if (melded_block.type == MeldType::Pon)
+            blocks[i].type = BlockType::Triplet | BlockType::Open;
+        else if (melded_block.type == MeldType::Chi)
+            blocks[i].type = BlockType::Sequence | BlockType::Open;
+        else if (melded_block.type == MeldType::Ankan)
+            blocks[i].type = BlockType::Kan;
+        else // 明槓、加槓
+            blocks[i].type = BlockType::Kan | BlockType::Open;
+        blocks[i].min_tile = Tile::to_normal(melded_block.tiles.front());
+
+        ++i;
+    }
+
+    const auto &hand = player.hand;
+    const HashType manzu = suits_hash(hand.begin(), hand.begin() + 9);
+    const HashType pinzu = suits_hash(hand.begin() + 9, hand.begin() + 18);
+    const HashType souzu = suits_hash(hand.begin() + 18, hand.begin() + 27);
+    const HashType honors = honors_hash(hand.begin() + 27, hand.begin() + 34);
+    ranges = {
+        get_patterns(suits_table_, manzu, 0),
+        get_patterns(suits_table_, pinzu, 9),
+        get_patterns(suits_table_, souzu, 18),
+        get_patterns(honors_table_, honors, 27),
+    };
+
+    return i;
+}
+
+/**
+ * @brief 和了牌を含むブロックの待ちの種類を取得する。
+ *
+ * @param[in] block 副露していないブロック
+ * @param[in] win_tile 和了牌
+ * @return 待ちの種類 (和了牌を含まない場合は WaitType::Null)
+ */
+int HandSeparator::get_wait_type(const Block &block, const int win_tile)
+{
+    if ((block.type & BlockType::Triplet) && block.min_tile == win_tile) {
+        return WaitType::DoublePairWait; // 双ポン待ち
+    }
+    else if (block.type == BlockType::Sequence && block.min_tile + 1 == win_tile) {
+        return WaitType::MiddleWait; // 嵌張待ち
+    }
+    else if (block.type == BlockType::Sequence && block.min_tile + 2 == win_tile &&
+             (block.min_tile == Tile::Manzu1 || block.min_tile == Tile::Pinzu1 ||
+              block.min_tile == Tile::Souzu1)) {
+        return WaitType::EdgeWait; // 辺張待ち 123
+    }
+    else if (block.type == BlockType::Sequence && block.min_tile == win_tile &&
+             (block.min_tile == Tile::Manzu7 || block.min_tile == Tile::Pinzu7 ||
+              block.min_tile == Tile::Souzu7)) {
+        return WaitType::EdgeWait; // 辺張待ち 789
+    }
+    else if (block.type == BlockType::Sequence &&
+             (block.min_tile == win_tile || block.min_tile + 2 == win_tile)) {
+        return WaitType::TwoSidedWait; // 両面待ち
+    }
+    else if (block.type == BlockType::Pair && block.min_tile == win_tile) {
+        return WaitType::SingleTileWait; // 単騎待ち
+    }
+
+    return WaitType::Null;
+}
+
+/**
+ * @brief テーブルのデータ部分 (ヘッダーを除く) のバイト数を計算する。
+ *
+ * @param[in] table テーブル
+ * @return バイト数
+ */
+size_t HandSeparator::data_size(const PatternTable &table)
+{
+    return (table.table_size + 1) * sizeof(uint32_t) +
+           (table.num_patterns + 1) * sizeof(uint32_t) +
+           table.num_blocks * sizeof(Block);
+}
+
+/**
+ * @brief テーブルのチェックサム (32 ビット単位の 64 ビット FNV-1a) を計算する。
+ *
+ * @param[in] table テーブル
+ * @return チェックサム
+ */
+uint64_t HandSeparator::checksum(const PatternTable &table)
+{
+    uint64_t hash = 0xcbf29ce484222325ull;
+    const auto update = [&hash](const void *data, const size_t size) {
+        const char *p = static_cast<const char *>(data);
+        for (size_t i = 0; i + sizeof(uint32_t) <= size; i += sizeof(uint32_t)) {
+            uint32_t value;
+            std::memcpy(&value, p + i, sizeof(value));
+            hash = (hash ^ value) * 0x100000001b3ull;
+        }
+    };
+
+    update(table.pattern_offsets, (table.table_size + 1) * sizeof(uint32_t));
+    update(table.block_offsets, (table.num_patterns + 1) * sizeof(uint32_t));
+    update(table.blocks, table.num_blocks * sizeof(Block));
+
+    return hash;
+}
+
+/**
+ * @brief テーブルファイルをメモリにマップする。
+ *        ページは同じファイルをマップする他のプロセスと共有される。
+ *
+ * @param[in] path パス
+ * @param[in] table_size テーブルサイズ
+ * @param[out] table テーブル
+ * @return マップに成功した場合は true、そうでない場合は false を返す。
+ */
+bool HandSeparator::map_table(const std::string &path, const size_t table_size,
+                              PatternTable &table)
+{
+    namespace bip = boost::interprocess;
+
+    bip::mapped_region region;
+    try {
+        const bip::file_mapping file(path.c_str(), bip::read_only);
+        region = bip::mapped_region(file, bip::read_only);
+    }
+    catch (const bip::interprocess_exception &e) {
+        spdlog::error(u8"Failed to map {}. (error: {})", path, e.what());
+        return false;
+    }
+
+    const char *data = static_cast<const char *>(region.get_address());
+    const size_t size = region.get_size();
+    if (size < sizeof(MappedTableHeader)) {
+        spdlog::error(u8"Invalid header of {}.", path);
+        return false;
+    }
+
+    MappedTableHeader header;
+    std::memcpy(&header, data, sizeof(header));
+
+    PatternTable mapped;
+    mapped.table_size = header.table_size;
+    mapped.num_patterns = header.num_patterns;
+    mapped.num_blocks = header.num_blocks;
+    if (header.magic != MappedTableMagic || header.version != MappedTableVersion ||
+        header.block_size != sizeof(Block) || header.table_size != table_size ||
+        size != sizeof(header) + data_size(mapped)) {
+        spdlog::error(u8"Incompatible {}. (version: {})", path, header.version);
+        return false;
+    }
+
+    // マップした領域はページ境界に揃っており、各配列は 4 バイト境界に揃っている。
+    const char *p = data + sizeof(header);
+    mapped.pattern_offsets = reinterpret_cast<const uint32_t *>(p);
+    p += (mapped.table_size + 1) * sizeof(uint32_t);
+    mapped.block_offsets = reinterpret_cast<const uint32_t *>(p);
+    p += (mapped.num_patterns + 1) * sizeof(uint32_t);
+    mapped.blocks = reinterpret_cast<const Block *>(p);
+
+    if (header.checksum != checksum(mapped)) {
+        spdlog::error(u8"Checksum mismatch of {}.", path);
+        return false;
+    }
+
+    table = mapped;
+    mapped_regions.push_back(std::move(region));
+
+    spdlog::info(u8"{} mapped. (patterns: {})", path, table.num_patterns);
+
+    return true;
+}
+
+/**
+ * @brief JSON ファイルからテーブルを作成する。
+ *
+ * @param[in] path パス
+ * @param[in] table_size テーブルサイズ
+ * @param[out] storage テーブルのデータ
+ * @param[out] table テーブル
+ * @return 作成に成功した場合は true、そうでない場合は false を返す。
+ */
+bool HandSeparator::make_table(const std::string &path, const size_t table_size,
+                               PatternTableStorage &storage, PatternTable &table)
+{
+    std::FILE *fp = std::fopen(path.c_str(), "rb");
+    if (!fp) {
+        spdlog::error(u8"Failed to open {}.", path);
+        return false;
+    }
+
+    std::vector<char> buffer(65536);
+    rapidjson::FileReadStream is(fp, buffer.data(), buffer.size());
+    rapidjson::Document doc;
+    doc.ParseStream(is);
+    std::fclose(fp);
+    if (doc.HasParseError()) {
+        spdlog::error(u8"Failed to parse {}.", path);
+        return false;
+    }
+
+    // JSON ファイルのキーは各牌の枚数を 8 進数で並べた値
+    const int num_tiles = table_size == SuitsTableSize ? 9 : 7;
+    std::map<HashType, std::vector<std::vector<Block>>> patterns;
+    for (auto &v : doc.GetArray()) {
+        int key = v["key"].GetInt();
+
+        std::array<int, 9> counts{};
+        for (int i = num_tiles - 1; i >= 0; --i) {
+            counts[i] = key % 8;
+            key /= 8;
+        }
+        const HashType hash =
+            num_tiles == 9 ? suits_hash(counts.begin(), counts.begin() + num_tiles)
+                           : honors_hash(counts.begin(), counts.begin() + num_tiles);
+
+        auto &hash_patterns = patterns[hash];
+        for (auto &v2 : v["pattern"].GetArray())
+            hash_patterns.push_back(get_blocks(v2.GetString()));
+    }
+
+    // 面子パターンを 1 つの配列に並べる。
+    storage.pattern_offsets.assign(table_size + 1, 0);
+    storage.block_offsets.assign(1, 0);
+    storage.blocks.clear();
+    auto it = patterns.begin();
+    for (size_t hash = 0; hash < table_size; ++hash) {
+        storage.pattern_offsets[hash] =
+            static_cast<uint32_t>(storage.block_offsets.size() - 1);
+        if (it == patterns.end() || static_cast<size_t>(it->first) != hash)
+            continue;
+
+        for (const auto &blocks : it->second) {
+            storage.blocks.insert(storage.blocks.end(), blocks.begin(), blocks.end());
+            storage.block_offsets.push_back(
+                static_cast<uint32_t>(storage.blocks.size()));
+        }
+        ++it;
+    }
+    storage.pattern_offsets[table_size] =
+        static_cast<uint32_t>(storage.block_offsets.size() - 1);
+
+    table.pattern_offsets = storage.pattern_offsets.data();
+    table.block_offsets = storage.block_offsets.data();
+    table.blocks = storage.blocks.data();
+    table.table_size = table_size;
+    table.num_patterns = storage.block_offsets.size() - 1;
+    table.num_blocks = storage.blocks.size();
+
+    spdlog::info(u8"{} loaded. (patterns: {})", path, table.num_patterns);
+
+    return true;
+}
+
+std::vector<Block> HandSeparator::get_blocks(const std::string &s)
+{
+    std::vector<Block> blocks;
+
+    size_t len = s.size();
+    for (size_t i = 0; i < len; i += 2) {
+        Block block;
+        block.min_tile = s[i] - '0';
+        if (s[i + 1] == 'k')
+            block.type = BlockType::Triplet;
+        else if (s[i + 1] == 's')
+            block.type = BlockType::Sequence;
+        else if (s[i + 1] == 'z')
+            block.type = BlockType::Pair;
+
+        blocks.emplace_back(block);
+    }
+
+    return blocks;
+}
+
+/**
+ * @brief ハッシュ値に対応する面子パターンの範囲を取得する。
+ *
+ * @param[in] table テーブル
+ * @param[in] hash ハッシュ値
+ * @param[in] offset ブロックの牌に加える値
+ * @return 面子パターンの範囲
+ */
+HandSeparator::PatternRange HandSeparator::get_patterns(const PatternTable &table,
+                                                        const HashType hash,
+                                                        const int offset)
+{
+    return {&table, table.pattern_offsets[hash], table.pattern_offsets[hash + 1],
+            offset};
+}
+
+HandSeparator::PatternTable HandSeparator::suits_table_;
+HandSeparator::PatternTable HandSeparator::honors_table_;
+static HandSeparator inst;
+
+} // namespace mahjong
@@ -1,10 +1,13 @@
 #ifndef MAHJONG_CPP_HAND_SEPARATOR
 #define MAHJONG_CPP_HAND_SEPARATOR
 
-#include <map>
+#include <array>
+#include <cstdint>
+#include <string>
 #include <tuple>
 #include <vector>
 
+#include "mahjong/core/nyanten_table.hpp"
 #include "mahjong/types/types.hpp"
 
 namespace mahjong
@@ -16,29 +19,237 @@ namespace mahjong
 class HandSeparator
 {
   public:
+    // テーブルサイズ (Nyanten ハッシュの最大値 + 1)
+    static constexpr size_t SuitsTableSize = 405350;
+    static constexpr size_t HonorsTableSize = 43130;
+
+    using HashType = int32_t;
+
+    /**
+     * @brief 面子パターンのテーブル
+     *        ハッシュ値 h の面子パターンは
+     *        [pattern_offsets[h], pattern_offsets[h + 1]) の範囲、
+     *        面子パターン p のブロックは
+     *        [block_offsets[p], block_offsets[p + 1]) の範囲にある。
+     */
+    struct PatternTable
+    {
+        /*! 各ハッシュ値の面子パターンの開始位置 (テーブルサイズ + 1 個) */
+        const uint32_t *pattern_offsets = nullptr;
+
+        /*! 各面子パターンのブロックの開始位置 (面子パターン数 + 1 個) */
+        const uint32_t *block_offsets = nullptr;
+
+        /*! 全面子パターンのブロック */
+        const Block *blocks = nullptr;
+
+        size_t table_size = 0;
+        size_t num_patterns = 0;
+        size_t num_blocks = 0;
+    };
+
+    /**
+     * @brief JSON ファイルから作成したテーブルのデータ
+     */
+    struct PatternTableStorage
+    {
+        std::vector<uint32_t> pattern_offsets;
+        std::vector<uint32_t> block_offsets;
+        std::vector<Block> blocks;
+    };
+
+    /**
+     * @brief マップ用のテーブルファイルのヘッダー
+     *        ヘッダーの後に pattern_offsets、block_offsets、blocks がこの順に続き、
+     *        メモリ上と同じレイアウト、ネイティブバイトオーダーで格納される。
+     */
+    struct MappedTableHeader
+    {
+        std::array<char, 8> magic;
+        uint32_t version;
+        uint32_t block_size;
+        uint64_t table_size;
+        uint64_t num_patterns;
+        uint64_t num_blocks;
+        uint64_t checksum;
+    };
+    static constexpr std::array<char, 8> MappedTableMagic = {'M', 'J', 'C', 'P',
+                                                             'P', 'P', 'A', 'T'};
+    static constexpr uint32_t MappedTableVersion = 1;
+
     HandSeparator();
     static bool initialize();
     static std::vector<std::tuple<std::vector<Block>, int>>
     separate(const PlayerState &player, const int win_tile, const int win_flag);
+    template <typename Visitor>
+    static void enumerate(const PlayerState &player, const int win_tile,
+                          const int win_flag, Visitor &&visitor);
+    template <typename ForwardIterator>
+    static HashType suits_hash(ForwardIterator first, ForwardIterator last);
+    template <typename ForwardIterator>
+    static HashType honors_hash(ForwardIterator first, ForwardIterator last);
+    static size_t data_size(const PatternTable &table);
+    static uint64_t checksum(const PatternTable &table);
 
   private:
-    static bool make_table(const std::string &path,
-                           std::map<int, std::vector<std::vector<Block>>> &table);
+    struct PatternRange
+    {
+        const PatternTable *table;
+        uint32_t first;
+        uint32_t last;
+        int offset;
+    };
+
+    static bool map_table(const std::string &path, const size_t table_size,
+                          PatternTable &table);
+    static bool make_table(const std::string &path, const size_t table_size,
+                           PatternTableStorage &storage, PatternTable &table);
     static std::vector<Block> get_blocks(const std::string &s);
-    static void
-    create_block_patterns(const int win_tile, const bool tsumo,
-                          std::vector<std::tuple<std::vector<Block>, int>> &patterns,
-                          std::vector<Block> &blocks, size_t i, int d,
-                          const std::vector<std::vector<Block>> &manzu,
-                          const std::vector<std::vector<Block>> &pinzu,
-                          const std::vector<std::vector<Block>> &souzu,
-                          const std::vector<std::vector<Block>> &honors);
+    static PatternRange get_patterns(const PatternTable &table, const HashType hash,
+                                     const int offset);
+    static size_t init_patterns(const PlayerState &player, std::array<Block, 5> &blocks,
+                                std::array<PatternRange, 4> &ranges);
+    static int get_wait_type(const Block &block, const int win_tile);
+    template <typename Visitor>
+    static void create_block_patterns(const int win_tile, const bool tsumo,
+                                      std::array<Block, 5> &blocks, size_t i, int d,
+                                      const std::array<PatternRange, 4> &ranges,
+                                      Visitor &visitor);
 
-  private:
-    static std::map<int, std::vector<std::vector<Block>>> s_tbl_;
-    static std::map<int, std::vector<std::vector<Block>>> z_tbl_;
+  public:
+    static PatternTable suits_table_;
+    static PatternTable honors_table_;
 };
 
+/**
+ * @brief 数牌のテーブルのハッシュ値を計算する。
+ *
+ * @param[in] first 枚数の範囲の先頭
+ * @param[in] last 枚数の範囲の末尾
+ * @return ハッシュ値
+ */
+template <typename ForwardIterator>
+inline HandSeparator::HashType HandSeparator::suits_hash(ForwardIterator first,
+                                                         ForwardIterator last)
+{
+    HashType h = 0;
+    std::uint_fast8_t i = 0;
+    std::uint_fast8_t n = 0;
+    while (first != last) {
+        const std::uint_fast8_t c = *first++;
+        n += c;
+        h += nyanten_suits_table[i][n][c];
+        ++i;
+    }
+
+    return h;
+}
+
+/**
+ * @brief 字牌のテーブルのハッシュ値を計算する。
+ *
+ * @param[in] first 枚数の範囲の先頭
+ * @param[in] last 枚数の範囲の末尾
+ * @return ハッシュ値
+ */
+template <typename ForwardIterator>
+inline HandSeparator::HashType HandSeparator::honors_hash(ForwardIterator first,
+                                                          ForwardIterator last)
+{
+    HashType h = 0;
+    std::uint_fast8_t i = 0;
+    std::uint_fast8_t n = 0;
+    while (first != last) {
+        const std::uint_fast8_t c = *first++;
+        n += c;
+        h += nyanten_honors_table[i][n][c];
+        ++i;
+    }
+
+    return h;
+}
+
+/**
+ * @brief 手牌の可能なブロック構成パターンを列挙する。
+ *        ブロック構成ごとに visitor(blocks, wait_type) を呼び出す。
+ *        blocks は呼び出しの間だけ有効で、コピーは作成しない。
+ *
+ * @param[in] player プレイヤーの状態
+ * @param[in] win_tile 和了牌
+ * @param[in] win_flag 和了フラグ
+ * @param[in] visitor const std::array<Block, 5> & と待ちの種類を受け取る関数
+ */
+template <typename Visitor>
+inline void HandSeparator::enumerate(const PlayerState &player, const int win_tile,
+                                     const int win_flag, Visitor &&visitor)
+{
+    std::array<Block, 5> blocks{};
+    std::array<PatternRange, 4> ranges;
+    const size_t i = init_patterns(player, blocks, ranges);
+
+    create_block_patterns(Tile::to_normal(win_tile), win_flag & WinFlag::Tsumo, blocks,
+                          i, 0, ranges, visitor);
+}
+
+/**
+ * @brief 面子構成と待ちの種類の組み合わせを列挙する。
+ *
+ * @param[in] win_tile 和了牌
+ * @param[in] tsumo 自摸かどうか
+ * @param[in] blocks 選択済みのブロック
+ * @param[in] i 選択済みのブロックの数
+ * @param[in] d 面子構成を選ぶ牌の種類 (萬子、筒子、索子、字牌、選択済み)
+ * @param[in] ranges 牌の種類ごとの面子パターンの範囲
+ * @param[in] visitor 面子構成と待ちの種類を受け取る関数
+ */
+template <typename Visitor>
+void HandSeparator::create_block_patterns(const int win_tile, const bool tsumo,
+                                          std::array<Block, 5> &blocks, size_t i,
+                                          int d,
+                                          const std::array<PatternRange, 4> &ranges,
+                                          Visitor &visitor)
+{
+    if (d == 4) {
+        const std::array<Block, 5> &pattern = blocks;
+        for (auto &block : blocks) {
+            if (block.type & BlockType::Open)
+                continue; // 副露ブロックは固定
+
+            const int wait_type = get_wait_type(block, win_tile);
+            if (wait_type == WaitType::Null)
+                continue;
+
+            if (tsumo) {
+                visitor(pattern, wait_type);
+            }
+            else {
+                // ロン和了の場合、和了牌を含むブロックは明刻、明順として扱う。
+                block.type |= BlockType::Open;
+                visitor(pattern, wait_type);
+                block.type &= ~BlockType::Open;
+            }
+        }
+
+        return;
+    }
+
+    // 萬子、筒子、索子、字牌の順に面子構成を選ぶ。
+    const PatternRange &range = ranges[d];
+    if (range.first == range.last)
+        create_block_patterns(win_tile, tsumo, blocks, i, d + 1, ranges, visitor);
+
+    for (uint32_t p = range.first; p < range.last; ++p) {
+        const uint32_t first = range.table->block_offsets[p];
+        const uint32_t last = range.table->block_offsets[p + 1];
+        for (uint32_t j = first; j < last; ++j) {
+            const Block &block = range.table->blocks[j];
+            blocks[i++] = {block.type, block.min_tile + range.offset};
+        }
+        create_block_patterns(win_tile, tsumo, blocks, i, d + 1, ranges, visitor);
+        i -= last - first;
+    }
+}
+
 } // namespace mahjong
 
 #endif /* MAHJONG_CPP_HAND_SEPARATOR */
@@ -0,0 +1,182 @@
+#include "incremental_tile_calculator.hpp"
+
+#include <numeric> // accumulate
+
+namespace mahjong
+{
+
+/**
+ * @brief Construct the calculator for the hand.
+ *
+ * @param[in] hand hand
+ * @param[in] num_melds number of melds
+ * @param[in] type shanten number type
+ * @param[in] game_mode Mahjong game mode
+ */
+IncrementalTileCalculator::IncrementalTileCalculator(const Hand &hand,
+                                                     const int num_melds,
+                                                     const int type,
+                                                     const int game_mode)
+    : hand_(hand)
+    , num_melds_(num_melds)
+    , num_tiles_(std::accumulate(hand.begin(), hand.begin() + 34, 0) + num_melds * 3)
+    , type_(type)
+    , game_mode_(game_mode)
+{
+    for (int block = 0; block < NumBlocks; ++block) {
+        hashes_[block] = calc_hash(block);
+    }
+    calculated_hashes_.fill(-1);
+}
+
+/**
+ * @brief Add the tile to the hand.
+ *
+ * @param[in] tile tile
+ */
+void IncrementalTileCalculator::draw(const int tile)
+{
+    ++hand_[tile];
+    if (Tile::is_red(tile)) {
+        ++hand_[Tile::to_normal(tile)];
+    }
+    ++num_tiles_;
+    update_hash(Tile::to_normal(tile));
+}
+
+/**
+ * @brief Remove the tile from the hand.
+ *
+ * @param[in] tile tile
+ */
+void IncrementalTileCalculator::discard(const int tile)
+{
+    --hand_[tile];
+    if (Tile::is_red(tile)) {
+        --hand_[Tile::to_normal(tile)];
+    }
+    --num_tiles_;
+    update_hash(Tile::to_normal(tile));
+}
+
+/**
+ * @brief Calculate the necessary tiles if the hand has 3n+1 tiles,
+ *        or the unnecessary tiles if the hand has 3n+2 tiles.
+ *
+ * @return (shanten flag, shanten number, necessary or unnecessary tiles)
+ */
+std::tuple<int, int, int64_t> IncrementalTileCalculator::result()
+{
+    const bool is_necessary = num_tiles_ % 3 == 1;
+
+    std::tuple<int, int, int64_t> ret = {ShantenFlag::None, 100, 0LL};
+
+    if (type_ & ShantenFlag::StandardHand) {
+        const auto [shanten, wait, disc] = calc_regular();
+        merge(ret, ShantenFlag::StandardHand, shanten, is_necessary ? wait : disc);
+    }
+
+    // Seven Pairs and Thirteen Orphans are cheap enough to calculate from scratch.
+    if ((type_ & ShantenFlag::SevenPairs) && num_melds_ == 0) {
+        const auto [shanten, wait, disc] =
+            game_mode_ == GameMode::Sanma
+                ? HandAnalyzer::calc_seven_pairs<GameMode::Sanma>(hand_)
+                : HandAnalyzer::calc_seven_pairs<GameMode::Yonma>(hand_);
+        merge(ret, ShantenFlag::SevenPairs, shanten, is_necessary ? wait : disc);
+    }
+
+    if ((type_ & ShantenFlag::ThirteenOrphans) && num_melds_ == 0) {
+        const auto [shanten, wait, disc] = HandAnalyzer::calc_thirteen_orphans(hand_);
+        merge(ret, ShantenFlag::ThirteenOrphans, shanten, is_necessary ? wait : disc);
+    }
+
+    return ret;
+}
+
+void IncrementalTileCalculator::merge(std::tuple<int, int, int64_t> &ret,
+                                      const int type, const int shanten,
+                                      const int64_t tiles)
+{
+    if (shanten < std::get<1>(ret)) {
+        ret = {type, shanten, tiles};
+    }
+    else if (shanten == std::get<1>(ret)) {
+        std::get<0>(ret) |= type;
+        std::get<2>(ret) |= tiles;
+    }
+}
+
+void IncrementalTileCalculator::update_hash(const int tile)
+{
+    const int block = tile < 9 ? Manzu : tile < 18 ? Pinzu : tile < 27 ? Souzu : Honors;
+    hashes_[block] = calc_hash(block);
+}
+
+Table::HashType IncrementalTileCalculator::calc_hash(const int block) const
+{
+    switch (block) {
+    case Manzu:
+        return game_mode_ == GameMode::Sanma
+                   ? Table::sanma_manzu_hash(hand_[Tile::Manzu1], hand_[Tile::Manzu9])
+                   : Table::suits_hash(hand_.begin(), hand_.begin() + 9);
+    case Pinzu:
+        return Table::suits_hash(hand_.begin() + 9, hand_.begin() + 18);
+    case Souzu:
+        return Table::suits_hash(hand_.begin() + 18, hand_.begin() + 27);
+    default:
+        return Table::honors_hash(hand_.begin() + 27, hand_.begin() + 34);
+    }
+}
+
+const Table::TableType &IncrementalTileCalculator::entry(const int block) const
+{
+    switch (block) {
+    case Manzu:
+        return game_mode_ == GameMode::Sanma ? Table::sanma_manzu_table_[hashes_[block]]
+                                             : Table::suits_table_[hashes_[block]];
+    case Honors:
+        return Table::honors_table_[hashes_[block]];
+    default:
+        return Table::suits_table_[hashes_[block]];
+    }
+}
+
+/**
+ * @brief Calculate the necessary tiles and the unnecessary tiles for regular hand.
+ *        The partial results are reused up to the first changed block.
+ *
+ * @return (shanten number, necessary tiles, unnecessary tiles)
+ */
+std::tuple<int, int64_t, int64_t> IncrementalTileCalculator::calc_regular()
+{
+    const int m = 4 - num_melds_;
+
+    int block = 0;
+    while (block < NumBlocks && calculated_hashes_[block] == hashes_[block]) {
+        ++block;
+    }
+
+    for (; block < NumBlocks; ++block) {
+        HandAnalyzer::ResultType &ret = partial_results_[block];
+        const Table::TableType &rhs = entry(block);
+        if (block == Honors) {
+            HandAnalyzer::init(ret, rhs);
+        }
+        else if (block == Manzu) {
+            ret = partial_results_[block - 1];
+            HandAnalyzer::add2(ret, rhs, m);
+        }
+        else {
+            ret = partial_results_[block - 1];
+            HandAnalyzer::add1(ret, rhs, m);
+        }
+        calculated_hashes_[block] = hashes_[block];
+    }
+
+    const HandAnalyzer::ResultType &ret = partial_results_[Manzu];
+    int shanten = static_cast<int>(ret[5 + m]) - 1;
+
+    return {shanten, ret[15 + m], ret[25 + m]};
+}
+
+} // namespace mahjong
@@ -0,0 +1,69 @@
+#ifndef MAHJONG_CPP_INCREMENTAL_TILE_CALCULATOR
+#define MAHJONG_CPP_INCREMENTAL_TILE_CALCULATOR
+
+#include <array>
+#include <cstdint>
+#include <tuple>
+
+#include "mahjong/core/hand_analyzer.hpp"
+#include "mahjong/core/table.hpp"
+#include "mahjong/types/types.hpp"
+
+namespace mahjong
+{
+
+/**
+ * @brief The IncrementalTileCalculator class calculates the necessary tiles or
+ *        the unnecessary tiles of a hand which changes one tile at a time.
+ *        It keeps the hash value of each suit and the partial results of combining
+ *        them, so only the changed suit is looked up and combined again.
+ */
+class IncrementalTileCalculator
+{
+  public:
+    IncrementalTileCalculator(const Hand &hand, int num_melds, int type, int game_mode);
+
+    void draw(int tile);
+    void discard(int tile);
+    std::tuple<int, int, int64_t> result();
+
+    const Hand &hand() const
+    {
+        return hand_;
+    }
+
+  private:
+    // The order of suits to combine, which determines the bit layout of the tiles.
+    enum Block
+    {
+        Honors,
+        Souzu,
+        Pinzu,
+        Manzu,
+        NumBlocks
+    };
+
+    static void merge(std::tuple<int, int, int64_t> &ret, int type, int shanten,
+                      int64_t tiles);
+    void update_hash(int tile);
+    Table::HashType calc_hash(int block) const;
+    const Table::TableType &entry(int block) const;
+    std::tuple<int, int64_t, int64_t> calc_regular();
+
+    Hand hand_;
+    int num_melds_;
+    int num_tiles_;
+    int type_;
+    int game_mode_;
+
+    /* hash value of each block of the current hand */
+    std::array<Table::HashType, NumBlocks> hashes_;
+    /* hash value of each block used to calculate the partial results */
+    std::array<Table::HashType, NumBlocks> calculated_hashes_;
+    /* results of combining the blocks from Honors to each block */
+    std::array<HandAnalyzer::ResultType, NumBlocks> partial_results_;
+};
+
+} // namespace mahjong
+
+#endif /* MAHJONG_CPP_INCREMENTAL_TILE_CALCULATOR */
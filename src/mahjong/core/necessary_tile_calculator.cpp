@@ -160,8 +160,11 @@ std::tuple<int, int64_t> NecessaryTileCalculator::calc_regular(const Hand &hand,
 
     int m = 4 - num_melds;
 
-    ResultType ret;
-    std::copy(honors.begin(), honors.end(), ret.begin());
+    ResultType ret{};
+    for (int i = 0; i < 10; ++i) {
+        ret[i] = Table::distance(honors, i);
+        ret[i + 10] = Table::wait(honors, i);
+    }
     add1(ret, souzu, m);
     add1(ret, pinzu, m);
     add2(ret, manzu, m);
@@ -268,16 +271,18 @@ void NecessaryTileCalculator::add1(ResultType &lhs, const Table::TableType &rhs,
                                    const int m)
 {
     auto lhs2 = &lhs[10];
-    const auto rhs2 = &rhs[10];
 
     for (int i = m + 5; i >= 5; --i) {
-        ResultType::value_type dist = lhs[i] + rhs[0];
-        ResultType::value_type wait = (lhs2[i] << 9) | rhs2[0];
-        shift(dist, lhs[0] + rhs[i], wait, (lhs2[0] << 9) | rhs2[i]);
+        ResultType::value_type dist = lhs[i] + Table::distance(rhs, 0);
+        ResultType::value_type wait = (lhs2[i] << 9) | Table::wait(rhs, 0);
+        shift(dist, lhs[0] + Table::distance(rhs, i), wait,
+              (lhs2[0] << 9) | Table::wait(rhs, i));
 
         for (int j = 5; j < i; ++j) {
-            shift(dist, lhs[j] + rhs[i - j], wait, (lhs2[j] << 9) | rhs2[i - j]);
-            shift(dist, lhs[i - j] + rhs[j], wait, (lhs2[i - j] << 9) | rhs2[j]);
+            shift(dist, lhs[j] + Table::distance(rhs, i - j), wait,
+                  (lhs2[j] << 9) | Table::wait(rhs, i - j));
+            shift(dist, lhs[i - j] + Table::distance(rhs, j), wait,
+                  (lhs2[i - j] << 9) | Table::wait(rhs, j));
         }
 
         lhs[i] = dist;
@@ -285,11 +290,12 @@ void NecessaryTileCalculator::add1(ResultType &lhs, const Table::TableType &rhs,
     }
 
     for (int i = m; i >= 0; --i) {
-        ResultType::value_type dist = lhs[i] + rhs[0];
-        ResultType::value_type wait = (lhs2[i] << 9) | rhs2[0];
+        ResultType::value_type dist = lhs[i] + Table::distance(rhs, 0);
+        ResultType::value_type wait = (lhs2[i] << 9) | Table::wait(rhs, 0);
 
         for (int j = 0; j < i; ++j) {
-            shift(dist, lhs[j] + rhs[i - j], wait, (lhs2[j] << 9) | rhs2[i - j]);
+            shift(dist, lhs[j] + Table::distance(rhs, i - j), wait,
+                  (lhs2[j] << 9) | Table::wait(rhs, i - j));
         }
 
         lhs[i] = dist;
@@ -301,15 +307,17 @@ void NecessaryTileCalculator::add2(ResultType &lhs, const Table::TableType &rhs,
                                    const int m)
 {
     auto lhs2 = &lhs[10];
-    const auto rhs2 = &rhs[10];
 
     int i = m + 5;
-    ResultType::value_type dist = lhs[i] + rhs[0];
-    ResultType::value_type wait = (lhs2[i] << 9) | rhs2[0];
-    shift(dist, lhs[0] + rhs[i], wait, (lhs2[0] << 9) | rhs2[i]);
+    ResultType::value_type dist = lhs[i] + Table::distance(rhs, 0);
+    ResultType::value_type wait = (lhs2[i] << 9) | Table::wait(rhs, 0);
+    shift(dist, lhs[0] + Table::distance(rhs, i), wait,
+          (lhs2[0] << 9) | Table::wait(rhs, i));
     for (int j = 5; j < i; ++j) {
-        shift(dist, lhs[j] + rhs[i - j], wait, (lhs2[j] << 9) | rhs2[i - j]);
-        shift(dist, lhs[i - j] + rhs[j], wait, (lhs2[i - j] << 9) | rhs2[j]);
+        shift(dist, lhs[j] + Table::distance(rhs, i - j), wait,
+              (lhs2[j] << 9) | Table::wait(rhs, i - j));
+        shift(dist, lhs[i - j] + Table::distance(rhs, j), wait,
+              (lhs2[i - j] << 9) | Table::wait(rhs, j));
     }
 
     lhs[i] = dist;
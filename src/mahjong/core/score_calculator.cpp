@@ -103,6 +103,12 @@ int get_yakuman_multiplier(const YakuValueTable &table, YakuFlags yaku) noexcept
     return 0;
 }
 
+int get_num_payments(const bool is_dealer, const bool is_tsumo) noexcept
+{
+    // Only a non-dealer tsumo has separate payments from the dealer and non-dealers.
+    return is_tsumo && !is_dealer ? 3 : 2;
+}
+
 } // namespace
 
 const YakuValueTable &ScoreCalculator::default_yaku_value_table()
@@ -214,38 +220,124 @@ ScoreResult ScoreCalculator::calc_fast(const TableConfig &table_config,
                                        const PlayerState &player, int win_tile,
                                        int win_flag, int shanten_type,
                                        const YakuValueTable &yaku_value_table)
+{
+    ScoreResult result;
+    const ScoreSummary summary = score_calculator_detail::evaluate(
+        table_config, round_state, table_state, player, win_tile, win_flag,
+        shanten_type, yaku_value_table, &result.yaku_list, &result.blocks);
+
+    if (!summary.success) {
+        result.err_msg = u8"No yaku is established.";
+        result.blocks.clear();
+        return result;
+    }
+
+    result.success = true;
+    result.han = summary.han;
+    result.fu = summary.fu;
+    result.score_limit = summary.score_limit;
+    result.payments.assign(summary.payments.begin(),
+                           summary.payments.begin() + summary.num_payments);
+    result.wait_type = summary.wait_type;
+    return result;
+}
+
+/**
+ * @brief Calculate score without the details of the yaku and blocks.
+ *        The result has no heap-allocated members, which suits evaluating many
+ *        winning hands such as in the expected score calculation.
+ *
+ * @param[in] table_config table configuration
+ * @param[in] round_state round state
+ * @param[in] table_state table state
+ * @param[in] PlayerState player
+ * @param[in] win_tile win tile
+ * @param[in] win_flag win flag
+ * @param[in] shanten_type shanten number type
+ * @return ScoreSummary
+ */
+ScoreSummary ScoreCalculator::calc_summary(const TableConfig &table_config,
+                                           const RoundState &round_state,
+                                           const TableState &table_state,
+                                           const PlayerState &player, int win_tile,
+                                           int win_flag, int shanten_type)
+{
+    return calc_summary(table_config, round_state, table_state, player, win_tile,
+                        win_flag, shanten_type, default_yaku_value_table());
+}
+
+/**
+ * @brief Calculate score without the details of the yaku and blocks.
+ *
+ * @param[in] table_config table configuration
+ * @param[in] round_state round state
+ * @param[in] table_state table state
+ * @param[in] PlayerState player
+ * @param[in] win_tile win tile
+ * @param[in] win_flag win flag
+ * @param[in] shanten_type shanten number type
+ * @param[in] yaku_value_table yaku value table
+ * @return ScoreSummary
+ */
+ScoreSummary ScoreCalculator::calc_summary(const TableConfig &table_config,
+                                           const RoundState &round_state,
+                                           const TableState &table_state,
+                                           const PlayerState &player, int win_tile,
+                                           int win_flag, int shanten_type,
+                                           const YakuValueTable &yaku_value_table)
+{
+    return score_calculator_detail::evaluate(table_config, round_state, table_state,
+                                             player, win_tile, win_flag, shanten_type,
+                                             yaku_value_table, nullptr, nullptr);
+}
+
+/**
+ * @brief Calculate score of a winning hand.
+ *
+ * @param[in] table_config table configuration
+ * @param[in] round_state round state
+ * @param[in] table_state table state
+ * @param[in] PlayerState player
+ * @param[in] win_tile win tile
+ * @param[in] win_flag win flag
+ * @param[in] shanten_type shanten number type
+ * @param[in] yaku_value_table yaku value table
+ * @param[out] yaku_han_list list of yaku with han value (optional)
+ * @param[out] blocks blocks of the hand (optional)
+ * @return ScoreSummary
+ */
+ScoreSummary score_calculator_detail::evaluate(
+    const TableConfig &table_config, const RoundState &round_state,
+    const TableState &table_state, const PlayerState &player, const int win_tile,
+    const int win_flag, const int shanten_type, const YakuValueTable &yaku_value_table,
+    std::vector<YakuEntry> *yaku_han_list, std::vector<Block> *blocks)
 {
     YakuFlags yaku_list = Yaku::None;
-    yaku_list |= score_calculator_detail::check_not_pattern_yaku(
-        table_config, round_state, player, win_tile, win_flag, shanten_type);
+    yaku_list |= check_not_pattern_yaku(table_config, round_state, player, win_tile,
+                                        win_flag, shanten_type);
 
     if (yaku_list & Yaku::NagashiMangan) {
-        return score_calculator_detail::aggregate(
-            table_config, round_state, table_state, player, win_tile, win_flag,
-            Yaku::NagashiMangan, yaku_value_table);
+        return aggregate(table_config, round_state, table_state, player, win_flag,
+                         Yaku::NagashiMangan, yaku_value_table, yaku_han_list);
     }
     else if (yaku_list & Yaku::YakumanMask) {
-        return score_calculator_detail::aggregate(
-            table_config, round_state, table_state, player, win_tile, win_flag,
-            yaku_list & Yaku::YakumanMask, yaku_value_table);
+        return aggregate(table_config, round_state, table_state, player, win_flag,
+                         yaku_list & Yaku::YakumanMask, yaku_value_table,
+                         yaku_han_list);
     }
 
     // 面子構成に関係ある役を調べる。
-    const auto [pattern_yaku_list, fu, blocks, wait_type] =
-        score_calculator_detail::check_pattern_yaku(round_state, player, win_tile,
-                                                    win_flag, shanten_type,
-                                                    yaku_value_table);
+    const auto [pattern_yaku_list, fu, wait_type] =
+        check_pattern_yaku(round_state, player, win_tile, win_flag, shanten_type,
+                           yaku_value_table, blocks);
     yaku_list |= pattern_yaku_list;
 
     if (!yaku_list) {
-        ScoreResult result;
-        result.err_msg = u8"No yaku is established.";
-        return result;
+        return ScoreSummary();
     }
 
-    return score_calculator_detail::aggregate(table_config, round_state, table_state,
-                                              player, win_tile, win_flag, yaku_list, fu,
-                                              blocks, wait_type, yaku_value_table);
+    return aggregate(table_config, round_state, table_state, player, win_flag,
+                     yaku_list, fu, wait_type, yaku_value_table, yaku_han_list);
 }
 
 /**
@@ -255,34 +347,38 @@ ScoreResult ScoreCalculator::calc_fast(const TableConfig &table_config,
  * @param[in] round_state round state
  * @param[in] table_state table state
  * @param[in] PlayerState player
- * @param[in] win_tile win tile
  * @param[in] win_flag win flag
  * @param[in] yaku_list list of yaku
  * @param[in] yaku_value_table yaku value table
- * @return ScoreResult
+ * @param[out] yaku_han_list list of yaku with han value (optional)
+ * @return ScoreSummary
  */
-ScoreResult score_calculator_detail::aggregate(const TableConfig &table_config,
-                                               const RoundState &round_state,
-                                               const TableState &table_state,
-                                               const PlayerState &player,
-                                               const int win_tile, const int win_flag,
-                                               YakuFlags yaku_list,
-                                               const YakuValueTable &yaku_value_table)
+ScoreSummary score_calculator_detail::aggregate(const TableConfig &table_config,
+                                                const RoundState &round_state,
+                                                const TableState &table_state,
+                                                const PlayerState &player,
+                                                const int win_flag, YakuFlags yaku_list,
+                                                const YakuValueTable &yaku_value_table,
+                                                std::vector<YakuEntry> *yaku_han_list)
 {
-    int score_title;
-    std::vector<YakuEntry> yaku_han_list;
-    std::vector<int> score;
+    ScoreSummary result;
+    result.success = true;
 
     const bool is_dealer = player.seat_wind == Tile::East;
 
     if (yaku_list & Yaku::NagashiMangan) {
         // Nagashi Mangan
-        yaku_han_list.push_back({Yaku::NagashiMangan, 0});
-        score_title = ScoreLimit::Mangan;
+        if (yaku_han_list) {
+            yaku_han_list->push_back({Yaku::NagashiMangan, 0});
+        }
+        result.yaku_list = Yaku::NagashiMangan;
+        result.score_limit = ScoreLimit::Mangan;
 
         // Nagashi Mangan is treated as Tsumo.
-        score = calc_score(is_dealer, true, round_state.honba, table_state.kyotaku,
-                           table_config.game_mode, score_title);
+        result.payments = calc_score(is_dealer, true, round_state.honba,
+                                     table_state.kyotaku, table_config.game_mode,
+                                     result.score_limit);
+        result.num_payments = get_num_payments(is_dealer, true);
     }
     else {
         // Count yakuman multiplier.
@@ -293,20 +389,21 @@ ScoreResult score_calculator_detail::aggregate(const TableConfig &table_config,
             if ((yaku & Yaku::YakumanMask) && (yaku_list & yaku)) {
                 const int multiplier = get_yakuman_multiplier(yaku_value_table, yaku);
                 n += multiplier;
-                yaku_han_list.push_back({yaku, multiplier});
+                result.yaku_list |= yaku;
+                if (yaku_han_list) {
+                    yaku_han_list->push_back({yaku, multiplier});
+                }
             }
         }
 
-        score_title = get_score_title(n);
-        score = calc_score(is_dealer, win_flag & WinFlag::Tsumo, round_state.honba,
-                           table_state.kyotaku, table_config.game_mode, score_title);
+        const bool is_tsumo = win_flag & WinFlag::Tsumo;
+        result.score_limit = get_score_title(n);
+        result.payments = calc_score(is_dealer, is_tsumo, round_state.honba,
+                                     table_state.kyotaku, table_config.game_mode,
+                                     result.score_limit);
+        result.num_payments = get_num_payments(is_dealer, is_tsumo);
     }
 
-    ScoreResult result;
-    result.success = true;
-    result.yaku_list = yaku_han_list;
-    result.score_limit = score_title;
-    result.payments = score;
     return result;
 }
 
@@ -317,93 +414,87 @@ ScoreResult score_calculator_detail::aggregate(const TableConfig &table_config,
  * @param[in] round_state round state
  * @param[in] table_state table state
  * @param[in] PlayerState player
- * @param[in] win_tile win tile
  * @param[in] win_flag win flag
  * @param[in] yaku_list list of yaku
  * @param[in] fu fu
- * @param[in] blocks list of blocks
  * @param[in] wait_type wait type
  * @param[in] yaku_value_table yaku value table
- * @return ScoreResult
+ * @param[out] yaku_han_list list of yaku with han value (optional)
+ * @return ScoreSummary
  */
-ScoreResult score_calculator_detail::aggregate(const TableConfig &table_config,
-                                               const RoundState &round_state,
-                                               const TableState &table_state,
-                                               const PlayerState &player,
-                                               const int win_tile, const int win_flag,
-                                               YakuFlags yaku_list, int fu,
-                                               const std::vector<Block> &blocks,
-                                               int wait_type,
-                                               const YakuValueTable &yaku_value_table)
+ScoreSummary score_calculator_detail::aggregate(const TableConfig &table_config,
+                                                const RoundState &round_state,
+                                                const TableState &table_state,
+                                                const PlayerState &player,
+                                                const int win_flag, YakuFlags yaku_list,
+                                                int fu, int wait_type,
+                                                const YakuValueTable &yaku_value_table,
+                                                std::vector<YakuEntry> *yaku_han_list)
 {
+    ScoreSummary result;
+    result.success = true;
+
     // Count total number of han.
     int han = 0;
-    std::vector<YakuEntry> yaku_han_list;
     for (YakuFlags yaku = 1LL; yaku <= 1LL << 39; yaku <<= 1) {
         // normal: 1LL << 0 ~ 1LL << 39
         if ((yaku & Yaku::NormalMask) && (yaku_list & yaku)) {
             const auto yaku_value = get_yaku_han(yaku_value_table, yaku);
             const int yaku_han =
                 player.is_closed() ? yaku_value.closed_han : yaku_value.open_han;
-            yaku_han_list.push_back({yaku, yaku_han});
+            result.yaku_list |= yaku;
+            if (yaku_han_list) {
+                yaku_han_list->push_back({yaku, yaku_han});
+            }
             han += yaku_han;
         }
     }
 
+    const auto add_dora = [&](const YakuFlags yaku, const int num) {
+        if (num) {
+            result.yaku_list |= yaku;
+            if (yaku_han_list) {
+                yaku_han_list->push_back({yaku, num});
+            }
+            han += num;
+        }
+    };
+
     // Count number of doras, uradoras and red doras.
     // Extracted north tiles (nuki dora) are also counted as dora/uradora when
     // north is indicated as dora.
     const int nuki_count =
         table_config.game_mode == GameMode::Sanma ? player.nuki_count : 0;
-    const int num_doras =
-        count_dora(player.hand, player.melds, table_state.dora_indicators,
-                   table_config.game_mode, nuki_count);
-    if (num_doras) {
-        yaku_han_list.push_back({Yaku::Dora, num_doras});
-        han += num_doras;
-    }
-
-    const int num_uradoras = count_dora(
-        player.hand, player.melds, table_state.uradora_indicators,
-        table_config.game_mode, nuki_count);
-    if (num_uradoras) {
-        yaku_han_list.push_back({Yaku::UraDora, num_uradoras});
-        han += num_uradoras;
-    }
+    add_dora(Yaku::Dora, count_dora(player.hand, player.melds,
+                                    table_state.dora_indicators,
+                                    table_config.game_mode, nuki_count));
+    add_dora(Yaku::UraDora, count_dora(player.hand, player.melds,
+                                       table_state.uradora_indicators,
+                                       table_config.game_mode, nuki_count));
 
     const bool rule_reddora = table_config.rule_flags & RuleFlag::RedDora;
-    const int num_reddoras = count_reddora(rule_reddora, player.hand, player.melds);
-    if (num_reddoras) {
-        yaku_han_list.push_back({Yaku::RedDora, num_reddoras});
-        han += num_reddoras;
-    }
+    add_dora(Yaku::RedDora, count_reddora(rule_reddora, player.hand, player.melds));
 
     // Count extracted north tiles (nuki dora). Each extracted north always counts
     // as one dora regardless of dora indicators.
-    if (nuki_count) {
-        yaku_han_list.push_back({Yaku::NukiDora, nuki_count});
-        han += nuki_count;
-    }
+    add_dora(Yaku::NukiDora, nuki_count);
 
-    const int score_title = get_score_title(fu, han);
     const bool is_dealer = player.seat_wind == Tile::East;
-    const std::vector<int> score =
-        calc_score(is_dealer, win_flag & WinFlag::Tsumo, round_state.honba,
-                   table_state.kyotaku, table_config.game_mode, score_title, han, fu);
-
-    std::sort(
-        yaku_han_list.begin(), yaku_han_list.end(),
-        [](const auto &a, const auto &b) { return a.yaku < b.yaku; });
-
-    ScoreResult result;
-    result.success = true;
-    result.yaku_list = yaku_han_list;
+    const bool is_tsumo = win_flag & WinFlag::Tsumo;
     result.han = han;
     result.fu = fu;
-    result.score_limit = score_title;
-    result.payments = score;
-    result.blocks = blocks;
+    result.score_limit = get_score_title(fu, han);
+    result.payments =
+        calc_score(is_dealer, is_tsumo, round_state.honba, table_state.kyotaku,
+                   table_config.game_mode, result.score_limit, han, fu);
+    result.num_payments = get_num_payments(is_dealer, is_tsumo);
     result.wait_type = wait_type;
+
+    if (yaku_han_list) {
+        std::sort(yaku_han_list->begin(), yaku_han_list->end(),
+                  [](const auto &a, const auto &b) { return a.yaku < b.yaku; });
+    }
+
     return result;
 }
 
@@ -490,7 +581,7 @@ score_calculator_detail::check_arguments(const PlayerState &player, int win_tile
  * @param[in] wind seat wind
  * @return int 符
  */
-int score_calculator_detail::calc_fu(const std::vector<Block> &blocks,
+int score_calculator_detail::calc_fu(const std::array<Block, 5> &blocks,
                                      const int wait_type, const bool is_closed,
                                      const bool is_tsumo, const bool is_pinfu,
                                      const int round_wind, const int wind)
@@ -587,6 +678,42 @@ std::vector<int> ScoreCalculator::get_up_scores(const TableConfig &table_config,
     return scores;
 }
 
+/**
+ * @brief Get the score when the han of the result increases.
+ *
+ * @param[in] table_config table configuration
+ * @param[in] round_state round state
+ * @param[in] table_state table state
+ * @param[in] player player state
+ * @param[in] result result of calc_summary()
+ * @param[in] win_flag win flag
+ * @param[in] n number of additional han
+ * @return winner score
+ */
+int ScoreCalculator::get_up_score(const TableConfig &table_config,
+                                  const RoundState &round_state,
+                                  const TableState &table_state,
+                                  const PlayerState &player, const ScoreSummary &result,
+                                  const int win_flag, const int n)
+{
+    if (!result.success) {
+        return 0;
+    }
+
+    if (result.score_limit >= ScoreLimit::CountedYakuman) {
+        return result.payments[0]; // Over yakuman
+    }
+
+    const int han = result.han + n;
+    const int score_title = score_calculator_detail::get_score_title(result.fu, han);
+    const bool is_dealer = player.seat_wind == Tile::East;
+    const bool tsumo = win_flag & WinFlag::Tsumo;
+    return score_calculator_detail::calc_score(is_dealer, tsumo, round_state.honba,
+                                               table_state.kyotaku,
+                                               table_config.game_mode, score_title,
+                                               han, result.fu)[0];
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////
 /// Helper functions for calculating score
 ////////////////////////////////////////////////////////////////////////////////////////
@@ -665,20 +792,23 @@ YakuFlags score_calculator_detail::check_not_pattern_yaku(const TableConfig &tab
  * @param[in] win_tile winning tile
  * @param[in] win_flag win flags
  * @param[in] shanten_type shanten type
- * @return (yaku, fu, list of blocks, wait type)
+ * @param[in] yaku_value_table yaku value table
+ * @param[out] blocks list of blocks with the highest score (optional)
+ * @return (yaku, fu, wait type)
  */
-std::tuple<YakuFlags, int, std::vector<Block>, int>
+std::tuple<YakuFlags, int, int>
 score_calculator_detail::check_pattern_yaku(const RoundState &round_state,
                                             const PlayerState &player,
                                             const int win_tile, const int win_flag,
                                             const int shanten_type,
-                                            const YakuValueTable &yaku_value_table)
+                                            const YakuValueTable &yaku_value_table,
+                                            std::vector<Block> *blocks)
 {
     if (shanten_type == ShantenFlag::SevenPairs) {
-        return {Yaku::None, 25, {}, WaitType::SingleTileWait};
+        return {Yaku::None, 25, WaitType::SingleTileWait};
     }
 
-    static const std::vector<YakuFlags> pattern_yaku = {
+    static constexpr std::array<YakuFlags, 11> pattern_yaku = {
         Yaku::Pinfu,
         Yaku::PureDoubleSequence,
         Yaku::AllTriplets,
@@ -692,19 +822,16 @@ score_calculator_detail::check_pattern_yaku(const RoundState &round_state,
         Yaku::TwicePureDoubleSequence,
     };
 
-    // Get list of block compositions.
-    const auto pattern = HandSeparator::separate(player, win_tile, win_flag);
-
-    // Find the block composition with the highest score.
+    // Evaluate each block composition and keep the one with the highest score.
     int max_han = 0;
     int max_fu = 0;
-    size_t max_idx;
-    YakuFlags max_yaku_list;
-    for (size_t i = 0; i < pattern.size(); ++i) {
+    int max_wait_type = WaitType::Null;
+    YakuFlags max_yaku_list = Yaku::None;
+    std::array<Block, 5> max_blocks{};
+    const auto evaluate_blocks = [&](const std::array<Block, 5> &blocks,
+                                     const int wait_type) {
         YakuFlags yaku_list = Yaku::None;
         int han, fu;
-        const std::vector<Block> &blocks = std::get<0>(pattern[i]);
-        int wait_type = std::get<1>(pattern[i]);
 
         // Check if Pinfu is established.
         const bool is_pinfu =
@@ -749,16 +876,20 @@ score_calculator_detail::check_pattern_yaku(const RoundState &round_state,
         if (max_han < han || (max_han == han && max_fu < fu)) {
             max_han = han;
             max_fu = fu;
-            max_idx = i;
+            max_wait_type = wait_type;
             max_yaku_list = yaku_list;
+            max_blocks = blocks;
         }
-    }
+    };
+    HandSeparator::enumerate(player, win_tile, win_flag, evaluate_blocks);
 
     max_fu = int(std::ceil(max_fu / 10.)) * 10;
-    ;
 
-    return {max_yaku_list, max_fu, std::get<0>(pattern[max_idx]),
-            std::get<1>(pattern[max_idx])};
+    if (blocks) {
+        blocks->assign(max_blocks.begin(), max_blocks.end());
+    }
+
+    return {max_yaku_list, max_fu, max_wait_type};
 }
 
 /**
@@ -775,69 +906,16 @@ score_calculator_detail::check_pattern_yaku(const RoundState &round_state,
  * @return (winner score, Non-dealer payment) if dealer wins by Tsumo.
  *         (winner score, dealer payment, Non-dealer payment) if PlayerState wins by Tsumo.
  *         (winner score, discarder payment) if dealer or PlayerState wins by Ron.
+ *         The remaining entries are 0.
  */
-std::vector<int>
+std::array<int, 3>
 score_calculator_detail::calc_score(const bool is_dealer, const bool is_tsumo,
                                     const int honba, const int kyotaku,
                                     const int game_mode, const int score_title,
                                     const int han, const int fu)
 {
-    using namespace ScoreTable;
-
-    const int fu_idx = ScoreTable::fu_to_index(fu);
-    const int han_idx = han - 1;
-    const int num_tsumo_payers = game_mode == GameMode::Sanma ? 2 : 3;
-
-    if (is_tsumo && is_dealer) {
-        // dealer tsumo
-        const int player_payment =
-            (score_title == ScoreLimit::Null
-                 ? BelowMangan[TsumoPlayerToDealer][fu_idx][han_idx]
-                 : AboveMangan[TsumoPlayerToDealer][score_title]) +
-            100 * honba;
-        const int score = 1000 * kyotaku + player_payment * num_tsumo_payers;
-
-        return {score, player_payment};
-    }
-    else if (is_tsumo && !is_dealer) {
-        // PlayerState tsumo
-        const int dealer_payment =
-            (score_title == ScoreLimit::Null
-                 ? BelowMangan[TsumoDealerToPlayer][fu_idx][han_idx]
-                 : AboveMangan[TsumoDealerToPlayer][score_title]) +
-            100 * honba;
-        const int player_payment =
-            (score_title == ScoreLimit::Null
-                 ? BelowMangan[TsumoPlayerToPlayer][fu_idx][han_idx]
-                 : AboveMangan[TsumoPlayerToPlayer][score_title]) +
-            100 * honba;
-        const int score =
-            1000 * kyotaku + dealer_payment + player_payment * (num_tsumo_payers - 1);
-
-        return {score, dealer_payment, player_payment};
-    }
-    else if (!is_tsumo && is_dealer) {
-        // dealer ron
-        const int honba_payment = (game_mode == GameMode::Sanma ? 200 : 300) * honba;
-        const int payment = (score_title == ScoreLimit::Null
-                                 ? BelowMangan[RonDiscarderToDealer][fu_idx][han_idx]
-                                 : AboveMangan[RonDiscarderToDealer][score_title]) +
-                            honba_payment;
-        const int score = 1000 * kyotaku + payment;
-
-        return {score, payment};
-    }
-    else {
-        // PlayerState ron
-        const int honba_payment = (game_mode == GameMode::Sanma ? 200 : 300) * honba;
-        const int payment = (score_title == ScoreLimit::Null
-                                 ? BelowMangan[RonDiscarderToPlayer][fu_idx][han_idx]
-                                 : AboveMangan[RonDiscarderToPlayer][score_title]) +
-                            honba_payment;
-        const int score = 1000 * kyotaku + payment;
-
-        return {score, payment};
-    }
+    return ScoreTable::payments(is_dealer, is_tsumo, honba, kyotaku, game_mode,
+                                score_title, han, fu);
 }
 
 /**
@@ -979,7 +1057,7 @@ int score_calculator_detail::get_score_title(const int n)
 /**
  * @brief Check if Pinfu (平和) is established.
  */
-bool score_calculator_detail::check_pinfu(const std::vector<Block> &blocks,
+bool score_calculator_detail::check_pinfu(const std::array<Block, 5> &blocks,
                                           const int wait_type, const int round_wind,
                                           const int wind)
 {
@@ -1009,12 +1087,12 @@ bool score_calculator_detail::check_pinfu(const std::vector<Block> &blocks,
  * @brief Check if Pure Double Sequence (一盃口) or
  *        Twice Pure Double Sequence (二盃口) is established.
  */
-YakuFlags
-score_calculator_detail::check_pure_double_sequence(const std::vector<Block> &blocks)
+YakuFlags score_calculator_detail::check_pure_double_sequence(
+    const std::array<Block, 5> &blocks)
 {
     // Before calling this function, Check if the hand is closed.
 
-    std::vector<int> count(34, 0);
+    std::array<int, 34> count{};
     for (const auto &block : blocks) {
         if (block.type & BlockType::Sequence) {
             count[block.min_tile]++; // sequence
@@ -1045,7 +1123,8 @@ score_calculator_detail::check_pure_double_sequence(const std::vector<Block> &bl
 /**
  * @brief Check if All Triplets (対々和) is established.
  */
-YakuFlags score_calculator_detail::check_all_triplets(const std::vector<Block> &blocks)
+YakuFlags
+score_calculator_detail::check_all_triplets(const std::array<Block, 5> &blocks)
 {
     for (const auto &block : blocks) {
         if (block.type & BlockType::Sequence) {
@@ -1060,7 +1139,7 @@ YakuFlags score_calculator_detail::check_all_triplets(const std::vector<Block> &
  * @brief Check if Three Concealed Triplets (三暗刻) is established.
  */
 YakuFlags score_calculator_detail::check_three_concealed_triplets(
-    const std::vector<Block> &blocks)
+    const std::array<Block, 5> &blocks)
 {
     int num_triplets = 0;
     for (const auto &block : blocks) {
@@ -1075,9 +1154,10 @@ YakuFlags score_calculator_detail::check_three_concealed_triplets(
 /**
  * @brief Check if Triple Triplets (三色同刻) is established.
  */
-bool score_calculator_detail::check_triple_triplets(const std::vector<Block> &blocks)
+bool score_calculator_detail::check_triple_triplets(
+    const std::array<Block, 5> &blocks)
 {
-    std::vector<int> count(34, 0);
+    std::array<int, 34> count{};
     for (const auto &block : blocks) {
         if (block.type & (BlockType::Triplet | BlockType::Kan)) {
             count[block.min_tile]++; // triplet, kong
@@ -1097,9 +1177,9 @@ bool score_calculator_detail::check_triple_triplets(const std::vector<Block> &bl
  * @brief Check if Mixed Triple Sequence (三色同順) is established.
  */
 bool score_calculator_detail::check_mixed_triple_sequence(
-    const std::vector<Block> &blocks)
+    const std::array<Block, 5> &blocks)
 {
-    std::vector<int> count(34, 0);
+    std::array<int, 34> count{};
     for (const auto &block : blocks) {
         if (block.type & BlockType::Sequence) {
             count[block.min_tile]++; // sequence
@@ -1118,9 +1198,10 @@ bool score_calculator_detail::check_mixed_triple_sequence(
 /**
  * @brief Check if Pure Straight (一気通貫) is established.
  */
-bool score_calculator_detail::check_pure_straight(const std::vector<Block> &blocks)
+bool score_calculator_detail::check_pure_straight(
+    const std::array<Block, 5> &blocks)
 {
-    std::vector<int> count(34, 0);
+    std::array<int, 34> count{};
     for (const auto &block : blocks) {
         if (block.type & BlockType::Sequence) {
             count[block.min_tile]++; // sequence
@@ -1137,7 +1218,8 @@ bool score_calculator_detail::check_pure_straight(const std::vector<Block> &bloc
  * @brief Check if Half Outside Hand (混全帯幺九) or
  *        Fully Outside Hand (純全帯幺九) is established.
  */
-YakuFlags score_calculator_detail::check_outside_hand(const std::vector<Block> &blocks)
+YakuFlags
+score_calculator_detail::check_outside_hand(const std::array<Block, 5> &blocks)
 {
     // | Yaku                     | Terminal | Honor | Sequence |
     // | Half Outside Hand        | o        | ○     | ○        |
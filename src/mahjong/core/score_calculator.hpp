@@ -1,6 +1,7 @@
 #ifndef SCORE_CALCULATOR_H
 #define SCORE_CALCULATOR_H
 
+#include <array>
 #include <string>
 #include <tuple>
 #include <vector>
@@ -78,12 +79,27 @@ class ScoreCalculator
                                  const PlayerState &player, int win_tile, int win_flag,
                                  int shanten_type,
                                  const YakuValueTable &yaku_value_table);
+    static ScoreSummary calc_summary(const TableConfig &table_config,
+                                     const RoundState &round_state,
+                                     const TableState &table_state,
+                                     const PlayerState &player, int win_tile,
+                                     int win_flag, int shanten_type);
+    static ScoreSummary calc_summary(const TableConfig &table_config,
+                                     const RoundState &round_state,
+                                     const TableState &table_state,
+                                     const PlayerState &player, int win_tile,
+                                     int win_flag, int shanten_type,
+                                     const YakuValueTable &yaku_value_table);
     static std::vector<int> get_up_scores(const TableConfig &table_config,
                                           const RoundState &round_state,
                                           const TableState &table_state,
                                           const PlayerState &player,
                                           const ScoreResult &result, const int win_flag,
                                           const int n);
+    static int get_up_score(const TableConfig &table_config,
+                            const RoundState &round_state,
+                            const TableState &table_state, const PlayerState &player,
+                            const ScoreSummary &result, int win_flag, int n);
 };
 
 namespace score_calculator_detail
@@ -93,30 +109,38 @@ using MergedHand = std::tuple<Hand, int32_t, int32_t, int32_t, int32_t>;
 
 std::tuple<bool, std::string> check_arguments(const PlayerState &player, int win_tile,
                                               int yaku_list);
-int calc_fu(const std::vector<Block> &blocks, const int wait_type, const bool is_closed,
-            const bool is_tsumo, const bool is_pinfu, const int round_wind,
-            const int wind);
-ScoreResult aggregate(const TableConfig &table_config, const RoundState &round_state,
-                      const TableState &table_state, const PlayerState &player,
-                      const int win_tile, const int win_flag, YakuFlags yaku_list,
-                      const YakuValueTable &yaku_value_table);
-ScoreResult aggregate(const TableConfig &table_config, const RoundState &round_state,
+int calc_fu(const std::array<Block, 5> &blocks, const int wait_type,
+            const bool is_closed, const bool is_tsumo, const bool is_pinfu,
+            const int round_wind, const int wind);
+ScoreSummary evaluate(const TableConfig &table_config, const RoundState &round_state,
                       const TableState &table_state, const PlayerState &player,
-                      const int win_tile, const int win_flag, YakuFlags yaku_list, int fu,
-                      const std::vector<Block> &blocks, int wait_type,
-                      const YakuValueTable &yaku_value_table);
+                      int win_tile, int win_flag, int shanten_type,
+                      const YakuValueTable &yaku_value_table,
+                      std::vector<YakuEntry> *yaku_han_list,
+                      std::vector<Block> *blocks);
+ScoreSummary aggregate(const TableConfig &table_config, const RoundState &round_state,
+                       const TableState &table_state, const PlayerState &player,
+                       const int win_flag, YakuFlags yaku_list,
+                       const YakuValueTable &yaku_value_table,
+                       std::vector<YakuEntry> *yaku_han_list);
+ScoreSummary aggregate(const TableConfig &table_config, const RoundState &round_state,
+                       const TableState &table_state, const PlayerState &player,
+                       const int win_flag, YakuFlags yaku_list, int fu, int wait_type,
+                       const YakuValueTable &yaku_value_table,
+                       std::vector<YakuEntry> *yaku_han_list);
 YakuFlags check_not_pattern_yaku(const TableConfig &table_config,
                                  const RoundState &round_state,
                                  const PlayerState &player,
                                  const int win_tile, const int win_flag,
                                  const int shanten_type);
-std::tuple<YakuFlags, int, std::vector<Block>, int>
+std::tuple<YakuFlags, int, int>
 check_pattern_yaku(const RoundState &round_state, const PlayerState &player,
                    const int win_tile, const int win_flag, const int shanten_type,
-                   const YakuValueTable &yaku_value_table);
-std::vector<int> calc_score(const bool is_dealer, const bool is_tsumo, const int honba,
-                            const int kyotaku, int game_mode, const int score_title,
-                            const int han = 0, const int fu = 0);
+                   const YakuValueTable &yaku_value_table, std::vector<Block> *blocks);
+std::array<int, 3> calc_score(const bool is_dealer, const bool is_tsumo,
+                              const int honba, const int kyotaku, int game_mode,
+                              const int score_title, const int han = 0,
+                              const int fu = 0);
 int count_dora(const Hand &hand, const std::vector<Meld> &melds,
                const std::vector<int> &indicators, int game_mode, int nuki_count = 0);
 int count_reddora(const bool rule_reddora, const Hand &hand,
@@ -141,15 +165,16 @@ YakuFlags check_tanyao(const PlayerState &player, const MergedHand &merged_hand,
 YakuFlags check_flush(const MergedHand &merged_hand);
 YakuFlags check_value_tile(const RoundState &round_state, const PlayerState &player,
                            const MergedHand &merged_hand);
-bool check_pinfu(const std::vector<Block> &blocks, const int wait_type,
+bool check_pinfu(const std::array<Block, 5> &blocks, const int wait_type,
                  const int round_wind, const int wind);
-YakuFlags check_pure_double_sequence(const std::vector<Block> &blocks);
-YakuFlags check_all_triplets(const std::vector<Block> &blocks);
-YakuFlags check_three_concealed_triplets(const std::vector<Block> &blocks);
-bool check_triple_triplets(const std::vector<Block> &blocks);
-bool check_mixed_triple_sequence(const std::vector<Block> &blocks);
-bool check_pure_straight(const std::vector<Block> &blocks);
-YakuFlags check_outside_hand(const std::vector<Block> &blocks);
+YakuFlags check_pure_double_sequence(const std::array<Block, 5> &blocks);
+YakuFlags check_all_triplets(const std::array<Block, 5> &blocks);
+YakuFlags
+check_three_concealed_triplets(const std::array<Block, 5> &blocks);
+bool check_triple_triplets(const std::array<Block, 5> &blocks);
+bool check_mixed_triple_sequence(const std::array<Block, 5> &blocks);
+bool check_pure_straight(const std::array<Block, 5> &blocks);
+YakuFlags check_outside_hand(const std::array<Block, 5> &blocks);
 
 } // namespace score_calculator_detail
 
@@ -1,179 +1,209 @@
-#ifndef MAHJONG_CPP_SCORE_TABLE
-#define MAHJONG_CPP_SCORE_TABLE
-
-#include <array>
-
-namespace mahjong
-{
-
-/**
- * @brief Score table
- */
-namespace ScoreTable
-{
-static int fu_to_index(int fu)
-{
-    switch (fu) {
-    case 20:
-        return 0;
-    case 25:
-        return 1;
-    case 30:
-        return 2;
-    case 40:
-        return 3;
-    case 50:
-        return 4;
-    case 60:
-        return 5;
-    case 70:
-        return 6;
-    case 80:
-        return 7;
-    case 90:
-        return 8;
-    case 100:
-        return 9;
-    case 110:
-        return 10;
-    default:
-        return -1;
-    }
-}
-
-/**
- * @brief Table to determine Mangan.
- */
-static const inline std::array<std::array<bool, 4>, 11> IsMangan = {{
-    // clang-format off
-    // 1han   2han   3han   4han
-    {false, false, false, false},  // 20fu
-    {false, false, false, false},  // 25fu
-    {false, false, false, false},  // 30fu
-    {false, false, false,  true},  // 40fu
-    {false, false, false,  true},  // 50fu
-    {false, false, false,  true},  // 60fu
-    {false, false,  true,  true},  // 70fu
-    {false, false,  true,  true},  // 80fu
-    {false, false,  true,  true},  // 90fu
-    {false, false,  true,  true},  // 100fu
-    {false, false,  true,  true},  // 110fu
-    // clang-format on
-}};
-
-enum
-{
-    RonDiscarderToDealer,
-    RonDiscarderToPlayer,
-    TsumoPlayerToDealer,
-    TsumoDealerToPlayer,
-    TsumoPlayerToPlayer,
-};
-
-/**
- * @brief Points paid by the discarder when the dealer wins by Ron.
- */
-static const inline std::array<std::array<std::array<int, 4>, 11>, 5> BelowMangan = {{
-    // (Ron) discarder -> dealer
-    {{
-        // clang-format off
-        // 1han   2han   3han   4han
-        {    0,     0,     0,     0}, // 20fu (20fu is Pinfu Tsumo only)
-        {    0,  2400,  4800,  9600}, // 25fu (25fu is Seven Pairs)
-        { 1500,  2900,  5800, 11600}, // 30fu
-        { 2000,  3900,  7700,     0}, // 40fu
-        { 2400,  4800,  9600,     0}, // 50fu
-        { 2900,  5800, 11600,     0}, // 60fu
-        { 3400,  6800,     0,     0}, // 70fu
-        { 3900,  7700,     0,     0}, // 80fu
-        { 4400,  8700,     0,     0}, // 90fu
-        { 4800,  9600,     0,     0}, // 100fu
-        { 5300, 10600,     0,     0}, // 110fu
-        // clang-format on
-    }},
-    // (Ron) discarder -> player
-    {{
-        // clang-format off
-        // 1han   2han   3han   4han
-        {    0,     0,     0,     0}, // 20fu (20fu is Pinfu Tsumo only)
-        {    0,  1600,  3200,  6400}, // 25fu (Seven Pairs)
-        { 1000,  2000,  3900,  7700}, // 30fu
-        { 1300,  2600,  5200,     0}, // 40fu
-        { 1600,  3200,  6400,     0}, // 50fu
-        { 2000,  3900,  7700,     0}, // 60fu
-        { 2300,  4500,     0,     0}, // 70fu
-        { 2600,  5200,     0,     0}, // 80fu
-        { 2900,  5800,     0,     0}, // 90fu
-        { 3200,  6400,     0,     0}, // 100fu
-        { 3600,  7100,     0,     0}, // 110fu
-        // clang-format on
-    }},
-    // (Tsumo) player -> dealer
-    {{
-        // clang-format off
-        // 1han   2han   3han   4han
-        {    0,   700,  1300,  2600}, // 20fu (Pinfu, Tsumo)
-        {    0,     0,  1600,  3200}, // 25fu (Seven Pairs, Tsumo)
-        {  500,  1000,  2000,  3900}, // 30fu
-        {  700,  1300,  2600,     0}, // 40fu
-        {  800,  1600,  3200,     0}, // 50fu
-        { 1000,  2000,  3900,     0}, // 60fu
-        { 1200,  2300,     0,     0}, // 70fu
-        { 1300,  2600,     0,     0}, // 80fu
-        { 1500,  2900,     0,     0}, // 90fu
-        { 1600,  3200,     0,     0}, // 100fu
-        { 1800,  3600,     0,     0}, // 110fu
-        // clang-format on
-    }},
-    // (Tsumo) dealer -> player
-    {{
-        // clang-format off
-        // 1han   2han   3han   4han
-        {    0,   700,  1300,  2600}, // 20fu (Pinfu, Tsumo)
-        {    0,     0,  1600,  3200}, // 25fu (Seven Pairs, Tsumo)
-        {  500,  1000,  2000,  3900}, // 30fu
-        {  700,  1300,  2600,     0}, // 40fu
-        {  800,  1600,  3200,     0}, // 50fu
-        { 1000,  2000,  3900,     0}, // 60fu
-        { 1200,  2300,     0,     0}, // 70fu
-        { 1300,  2600,     0,     0}, // 80fu
-        { 1500,  2900,     0,     0}, // 90fu
-        { 1600,  3200,     0,     0}, // 100fu
-        { 1800,  3600,     0,     0}, // 110fu
-        // clang-format on
-    }},
-    // (Tsumo) player -> player
-    {{
-        // clang-format off
-        // 1han   2han   3han   4han
-        {    0,   400,   700,  1300}, // 20fu (Pinfu, Tsumo)
-        {    0,     0,   800,  1600}, // 25fu (Seven Pairs, Tsumo)
-        {  300,   500,  1000,  2000}, // 30fu
-        {  400,   700,  1300,     0}, // 40fu
-        {  400,   800,  1600,     0}, // 50fu
-        {  500,  1000,  2000,     0}, // 60fu
-        {  600,  1200,     0,     0}, // 70fu
-        {  700,  1300,     0,     0}, // 80fu
-        {  800,  1500,     0,     0}, // 90fu
-        {  800,  1600,     0,     0}, // 100fu
-        {  900,  800,      0,     0}, // 110fu
-        // clang-format on
-    }},
-}};
-
-static const inline std::array<std::array<int, 11>, 5> AboveMangan = {
-    {// (Ron) discarder -> dealer
-     {12000, 18000, 24000, 36000, 48000, 48000, 96000, 144000, 192000, 240000, 288000},
-     // (Ron) discarder -> player
-     {8000, 12000, 16000, 24000, 32000, 32000, 64000, 96000, 128000, 160000, 192000},
-     // (Tsumo) player -> dealer
-     {4000, 6000, 8000, 12000, 16000, 16000, 32000, 48000, 64000, 80000, 96000},
-     // (Tsumo) dealer -> player
-     {4000, 6000, 8000, 12000, 16000, 16000, 32000, 48000, 64000, 80000, 96000},
-     // (Tsumo) player -> player
-     {2000, 3000, 4000, 6000, 8000, 8000, 16000, 24000, 32000, 40000, 48000}}};
-}; // namespace ScoreTable
-
-} // namespace mahjong
-
-#endif /* MAHJONG_CPP_SCORE_TABLE */
+#ifndef MAHJONG_CPP_SCORE_TABLE
+#define MAHJONG_CPP_SCORE_TABLE
+
+#include <algorithm>
+#include <array>
+
+#include "mahjong/types/constants.hpp"
+
+namespace mahjong
+{
+
+/**
+ * @brief Score table
+ */
+namespace ScoreTable
+{
+
+/*! Number of fu in the score table (20, 25, 30, 40, ..., 110). */
+inline constexpr int NumFu = 11;
+
+/*! Number of han that can be below Mangan (1, 2, 3, 4). */
+inline constexpr int NumHan = 4;
+
+/*! Number of entries in the payment table (han and fu below Mangan, score titles). */
+inline constexpr int NumEntries = NumFu * NumHan + ScoreLimit::Length;
+
+/**
+ * @brief Get the index of fu in the score table.
+ *
+ * @param[in] fu fu
+ * @return index of fu, or -1 if fu is not in the score table
+ */
+constexpr int fu_to_index(const int fu)
+{
+    if (fu == 20) {
+        return 0;
+    }
+    if (fu == 25) {
+        return 1;
+    }
+    if (fu >= 30 && fu <= 110 && fu % 10 == 0) {
+        return fu / 10 - 1;
+    }
+
+    return -1;
+}
+
+/**
+ * @brief Get fu of the index in the score table.
+ *
+ * @param[in] fu_idx index of fu
+ * @return fu
+ */
+constexpr int index_to_fu(const int fu_idx)
+{
+    return fu_idx == 0 ? 20 : fu_idx == 1 ? 25 : (fu_idx + 1) * 10;
+}
+
+/**
+ * @brief Get the basic points (fu x 2^(han + 2), at most 2000 below Mangan).
+ *
+ * @param[in] score_title score title
+ * @param[in] han han
+ * @param[in] fu fu
+ * @return basic points
+ */
+constexpr int base_points(const int score_title, const int han, const int fu)
+{
+    constexpr std::array<int, ScoreLimit::Length> limit_points = {
+        2000, 3000, 4000, 6000, 8000, 8000, 16000, 24000, 32000, 40000, 48000};
+
+    if (score_title == ScoreLimit::Null) {
+        return std::min(fu << (han + 2), 2000);
+    }
+
+    return limit_points[score_title];
+}
+
+/**
+ * @brief Round up points to the nearest 100.
+ */
+constexpr int round_up_100(const int points)
+{
+    return (points + 99) / 100 * 100;
+}
+
+/**
+ * @brief Get the index of the payment table entry.
+ *
+ * @param[in] score_title score title
+ * @param[in] han han (used only below Mangan)
+ * @param[in] fu fu (used only below Mangan)
+ * @return index of the entry
+ */
+constexpr int to_entry_index(const int score_title, const int han, const int fu)
+{
+    return score_title == ScoreLimit::Null ? fu_to_index(fu) * NumHan + han - 1
+                                           : NumFu * NumHan + score_title;
+}
+
+/**
+ * @brief Table to determine Mangan. [fu index][han - 1]
+ */
+inline constexpr std::array<std::array<bool, NumHan>, NumFu> IsMangan = [] {
+    std::array<std::array<bool, NumHan>, NumFu> table{};
+    for (int fu_idx = 0; fu_idx < NumFu; ++fu_idx) {
+        for (int han_idx = 0; han_idx < NumHan; ++han_idx) {
+            const int fu = index_to_fu(fu_idx);
+            table[fu_idx][han_idx] = (fu << (han_idx + 3)) >= 2000;
+        }
+    }
+
+    return table;
+}();
+
+using PaymentTableType =
+    std::array<std::array<std::array<std::array<std::array<int, 3>, NumEntries>, 2>, 2>,
+               GameMode::Length>;
+
+/**
+ * @brief Payments without honba and kyotaku. [game mode][is dealer][is tsumo][entry]
+ *        Each entry is (winner score, payment, payment) in the same form as
+ *        score_calculator_detail::calc_score().
+ */
+inline constexpr PaymentTableType Payments = [] {
+    PaymentTableType table{};
+    for (int game_mode = 0; game_mode < GameMode::Length; ++game_mode) {
+        const int num_tsumo_payers = game_mode == GameMode::Sanma ? 2 : 3;
+
+        for (int index = 0; index < NumEntries; ++index) {
+            const bool is_limit = index >= NumFu * NumHan;
+            const int score_title =
+                is_limit ? index - NumFu * NumHan : ScoreLimit::Null;
+            const int han = is_limit ? 0 : index % NumHan + 1;
+            const int fu = is_limit ? 0 : index_to_fu(index / NumHan);
+            const int base = base_points(score_title, han, fu);
+
+            // dealer tsumo
+            const int dealer_tsumo = round_up_100(2 * base);
+            table[game_mode][1][1][index] = {dealer_tsumo * num_tsumo_payers,
+                                             dealer_tsumo, 0};
+
+            // player tsumo
+            const int dealer_payment = round_up_100(2 * base);
+            const int player_payment = round_up_100(base);
+            table[game_mode][0][1][index] = {
+                dealer_payment + player_payment * (num_tsumo_payers - 1),
+                dealer_payment, player_payment};
+
+            // dealer ron
+            const int dealer_ron = round_up_100(6 * base);
+            table[game_mode][1][0][index] = {dealer_ron, dealer_ron, 0};
+
+            // player ron
+            const int player_ron = round_up_100(4 * base);
+            table[game_mode][0][0][index] = {player_ron, player_ron, 0};
+        }
+    }
+
+    return table;
+}();
+
+/**
+ * @brief Get the score and payments.
+ *
+ * @param[in] is_dealer Whether the player is dealer
+ * @param[in] is_tsumo Whether the player wins by Tsumo
+ * @param[in] honba honba
+ * @param[in] kyotaku kyotaku
+ * @param[in] game_mode Mahjong game mode
+ * @param[in] score_title score title
+ * @param[in] han han
+ * @param[in] fu fu
+ * @return (winner score, payment, payment) as score_calculator_detail::calc_score()
+ */
+constexpr std::array<int, 3> payments(const bool is_dealer, const bool is_tsumo,
+                                      const int honba, const int kyotaku,
+                                      const int game_mode, const int score_title,
+                                      const int han, const int fu)
+{
+    const auto &entry = Payments[game_mode][is_dealer][is_tsumo]
+                                [to_entry_index(score_title, han, fu)];
+
+    // Each payer pays 100 points per honba, and a Ron discarder pays for all payers.
+    const int num_tsumo_payers = game_mode == GameMode::Sanma ? 2 : 3;
+    const int honba_payment = 100 * honba;
+    const int score = entry[0] + 1000 * kyotaku + honba_payment * num_tsumo_payers;
+    if (!is_tsumo) {
+        return {score, entry[1] + honba_payment * num_tsumo_payers, 0};
+    }
+    if (is_dealer) {
+        return {score, entry[1] + honba_payment, 0};
+    }
+
+    return {score, entry[1] + honba_payment, entry[2] + honba_payment};
+}
+
+static_assert(
+    payments(false, false, 0, 0, GameMode::Yonma, ScoreLimit::Null, 4, 30)[1] == 7700);
+static_assert(
+    payments(true, true, 1, 1, GameMode::Yonma, ScoreLimit::Null, 2, 20)[0] == 3400);
+static_assert(
+    payments(false, true, 0, 0, GameMode::Sanma, ScoreLimit::Mangan, 5, 0)[0] == 6000);
+
+} // namespace ScoreTable
+
+} // namespace mahjong
+
+#endif /* MAHJONG_CPP_SCORE_TABLE */
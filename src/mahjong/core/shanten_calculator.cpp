@@ -15,6 +15,10 @@
 #include <numeric>   // accumulate
 #include <stdexcept> // invalid_argument
 
+#if defined(__AVX2__) || defined(__SSE4_1__)
+#include <immintrin.h>
+#endif
+
 #include <spdlog/spdlog.h>
 
 #include "mahjong/core/utils.hpp"
@@ -23,6 +27,167 @@
 namespace mahjong
 {
 
+namespace
+{
+
+/**
+ * @brief Operations on distances of several hands held in SIMD lanes.
+ *        The widest instruction set enabled at build time is used.
+ */
+#if defined(__AVX2__)
+struct Lanes
+{
+    static constexpr size_t Width = 8;
+    using Type = __m256i;
+
+    static Type load(const Table::TableType *table, const Table::HashType *hashes,
+                     const int i)
+    {
+        // Each lane gathers the i-th element of its table entry.
+        const __m256i stride = _mm256_set1_epi32(sizeof(Table::TableType) / 4);
+        const __m256i hash =
+            _mm256_loadu_si256(reinterpret_cast<const __m256i *>(hashes));
+        const __m256i index =
+            _mm256_add_epi32(_mm256_mullo_epi32(hash, stride), _mm256_set1_epi32(i));
+        const __m256i value =
+            _mm256_i32gather_epi32(reinterpret_cast<const int *>(table), index, 4);
+#ifdef USE_PACKED_TABLE
+        return _mm256_and_si256(value, _mm256_set1_epi32(0b1111));
+#else
+        return value;
+#endif
+    }
+
+    static Type add(const Type lhs, const Type rhs)
+    {
+        return _mm256_add_epi32(lhs, rhs);
+    }
+
+    static Type min(const Type lhs, const Type rhs)
+    {
+        return _mm256_min_epi32(lhs, rhs);
+    }
+
+    static void store(int *dst, const Type value)
+    {
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst), value);
+    }
+};
+#elif defined(__SSE4_1__)
+struct Lanes
+{
+    static constexpr size_t Width = 4;
+    using Type = __m128i;
+
+    static Type load(const Table::TableType *table, const Table::HashType *hashes,
+                     const int i)
+    {
+        return _mm_setr_epi32(
+            Table::distance(table[hashes[0]], i), Table::distance(table[hashes[1]], i),
+            Table::distance(table[hashes[2]], i), Table::distance(table[hashes[3]], i));
+    }
+
+    static Type add(const Type lhs, const Type rhs)
+    {
+        return _mm_add_epi32(lhs, rhs);
+    }
+
+    static Type min(const Type lhs, const Type rhs)
+    {
+        return _mm_min_epi32(lhs, rhs);
+    }
+
+    static void store(int *dst, const Type value)
+    {
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst), value);
+    }
+};
+#else
+struct Lanes
+{
+    static constexpr size_t Width = 1;
+    using Type = int32_t;
+
+    static Type load(const Table::TableType *table, const Table::HashType *hashes,
+                     const int i)
+    {
+        return Table::distance(table[hashes[0]], i);
+    }
+
+    static Type add(const Type lhs, const Type rhs)
+    {
+        return lhs + rhs;
+    }
+
+    static Type min(const Type lhs, const Type rhs)
+    {
+        return std::min(lhs, rhs);
+    }
+
+    static void store(int *dst, const Type value)
+    {
+        *dst = value;
+    }
+};
+#endif
+
+// std::array would drop the alignment attributes of the SIMD types.
+struct LanesResultType
+{
+    Lanes::Type values[10];
+
+    Lanes::Type &operator[](const int i)
+    {
+        return values[i];
+    }
+
+    const Lanes::Type &operator[](const int i) const
+    {
+        return values[i];
+    }
+};
+
+/**
+ * @brief Loads the distances used for combining blocks of the given number of melds.
+ */
+void load_lanes(LanesResultType &ret, const Table::TableType *table,
+                const Table::HashType *hashes, const int m)
+{
+    for (int i = 0; i <= m; ++i) {
+        ret[i] = Lanes::load(table, hashes, i);
+        ret[i + 5] = Lanes::load(table, hashes, i + 5);
+    }
+}
+
+/**
+ * @brief Lane version of ShantenCalculator::add1 (Full = true) and add2 (Full = false).
+ */
+template <bool Full>
+void add_lanes(LanesResultType &lhs, const LanesResultType &rhs, const int m)
+{
+    for (int i = m + 5; i >= (Full ? 5 : m + 5); --i) {
+        Lanes::Type dist =
+            Lanes::min(Lanes::add(lhs[i], rhs[0]), Lanes::add(lhs[0], rhs[i]));
+        for (int j = 5; j < i; ++j) {
+            dist = Lanes::min(dist, Lanes::add(lhs[j], rhs[i - j]));
+            dist = Lanes::min(dist, Lanes::add(lhs[i - j], rhs[j]));
+        }
+        lhs[i] = dist;
+    }
+
+    if constexpr (Full) {
+        for (int i = m; i >= 0; --i) {
+            Lanes::Type dist = Lanes::add(lhs[i], rhs[0]);
+            for (int j = 0; j < i; ++j) {
+                dist = Lanes::min(dist, Lanes::add(lhs[j], rhs[i - j]));
+            }
+            lhs[i] = dist;
+        }
+    }
+}
+
+} // namespace
+
 /**
  * @brief Calculate the shanten number.
  *
@@ -119,7 +284,9 @@ int ShantenCalculator::calc_regular(const Hand &hand, const int num_melds)
     int m = 4 - num_melds;
 
     ResultType ret;
-    std::copy(manzu.begin(), manzu.begin() + 10, ret.begin());
+    for (int i = 0; i < 10; ++i) {
+        ret[i] = Table::distance(manzu, i);
+    }
     add1(ret, pinzu, m);
     add1(ret, souzu, m);
     add2(ret, honors, m);
@@ -127,6 +294,118 @@ int ShantenCalculator::calc_regular(const Hand &hand, const int num_melds)
     return ret[5 + m] - 1;
 }
 
+/**
+ * @brief Calculate the shanten numbers of many hands.
+ *        The regular hand is calculated for several hands at once in SIMD lanes.
+ *
+ * @param[in] hands The hands
+ * @param[in] num_hands The number of hands
+ * @param[in] num_melds The number of melds of each hand
+ * @param[in] type The type of shanten number to calculate
+ * @param[in] game_mode Mahjong game mode
+ * @param[out] results (Type of shanten number, shanten number) of each hand
+ */
+void ShantenCalculator::calc_batch(const Hand *hands, const size_t num_hands,
+                                   const int num_melds, const int type,
+                                   const int game_mode, std::tuple<int, int> *results)
+{
+    std::vector<int> regular(type & ShantenFlag::StandardHand ? num_hands : 0);
+    if (type & ShantenFlag::StandardHand) {
+        if (game_mode == GameMode::Sanma) {
+            calc_regular_batch<GameMode::Sanma>(hands, num_hands, num_melds,
+                                                regular.data());
+        }
+        else {
+            calc_regular_batch<GameMode::Yonma>(hands, num_hands, num_melds,
+                                                regular.data());
+        }
+    }
+
+    for (size_t i = 0; i < num_hands; ++i) {
+        // The other types are cheap enough to calculate by calc().
+        results[i] = calc(hands[i], num_melds, type & ~ShantenFlag::StandardHand,
+                          game_mode);
+        if (type & ShantenFlag::StandardHand) {
+            auto &[result_type, shanten] = results[i];
+            if (regular[i] < shanten) {
+                results[i] = {ShantenFlag::StandardHand, regular[i]};
+            }
+            else if (regular[i] == shanten) {
+                result_type |= ShantenFlag::StandardHand;
+            }
+        }
+    }
+}
+
+/**
+ * @brief Calculate the shanten numbers of many hands.
+ *
+ * @param[in] hands The hands
+ * @param[in] num_melds The number of melds of each hand
+ * @param[in] type The type of shanten number to calculate
+ * @param[in] game_mode Mahjong game mode
+ * @return std::vector<std::tuple<int, int>> (Type of shanten number, shanten number)
+ *         of each hand
+ */
+std::vector<std::tuple<int, int>>
+ShantenCalculator::calc_batch(const std::vector<Hand> &hands, const int num_melds,
+                              const int type, const int game_mode)
+{
+    std::vector<std::tuple<int, int>> results(hands.size());
+    calc_batch(hands.data(), hands.size(), num_melds, type, game_mode, results.data());
+
+    return results;
+}
+
+template <int Mode>
+void ShantenCalculator::calc_regular_batch(const Hand *hands, const size_t num_hands,
+                                           const int num_melds, int *shanten)
+{
+    const int m = 4 - num_melds;
+    const size_t num_blocks = num_hands / Lanes::Width;
+
+    for (size_t block = 0; block < num_blocks; ++block) {
+        const Hand *first = hands + block * Lanes::Width;
+
+        // Hash values of each suit in structure-of-arrays form.
+        std::array<std::array<Table::HashType, Lanes::Width>, 4> hashes;
+        for (size_t k = 0; k < Lanes::Width; ++k) {
+            const Hand &hand = first[k];
+            if constexpr (Mode == GameMode::Sanma) {
+                hashes[0][k] =
+                    Table::sanma_manzu_hash(hand[Tile::Manzu1], hand[Tile::Manzu9]);
+            }
+            else {
+                hashes[0][k] = Table::suits_hash(hand.begin(), hand.begin() + 9);
+            }
+            hashes[1][k] = Table::suits_hash(hand.begin() + 9, hand.begin() + 18);
+            hashes[2][k] = Table::suits_hash(hand.begin() + 18, hand.begin() + 27);
+            hashes[3][k] = Table::honors_hash(hand.begin() + 27, hand.begin() + 34);
+        }
+
+        const Table::TableType *manzu_table = Mode == GameMode::Sanma
+                                                  ? Table::sanma_manzu_table_.data()
+                                                  : Table::suits_table_;
+        LanesResultType ret, rhs;
+        load_lanes(ret, manzu_table, hashes[0].data(), m);
+        load_lanes(rhs, Table::suits_table_, hashes[1].data(), m);
+        add_lanes<true>(ret, rhs, m);
+        load_lanes(rhs, Table::suits_table_, hashes[2].data(), m);
+        add_lanes<true>(ret, rhs, m);
+        load_lanes(rhs, Table::honors_table_, hashes[3].data(), m);
+        add_lanes<false>(ret, rhs, m);
+
+        Lanes::store(shanten + block * Lanes::Width, ret[5 + m]);
+        for (size_t k = 0; k < Lanes::Width; ++k) {
+            shanten[block * Lanes::Width + k] -= 1;
+        }
+    }
+
+    for (size_t i = num_blocks * Lanes::Width; i < num_hands; ++i) {
+        shanten[i] = calc_regular<Mode>(hands[i], num_melds);
+    }
+}
+
 /**
  * @brief Calculate the shanten number for Seven Pairs.
  *
@@ -175,18 +454,19 @@ int ShantenCalculator::calc_thirteen_orphans(const Hand &hand)
 void ShantenCalculator::add1(ResultType &lhs, const Table::TableType &rhs, const int m)
 {
     for (int i = m + 5; i >= 5; --i) {
-        int32_t dist = std::min(lhs[i] + rhs[0], lhs[0] + rhs[i]);
+        int32_t dist = std::min(lhs[i] + Table::distance(rhs, 0),
+                                lhs[0] + Table::distance(rhs, i));
         for (int j = 5; j < i; ++j) {
-            dist = std::min(dist, lhs[j] + rhs[i - j]);
-            dist = std::min(dist, lhs[i - j] + rhs[j]);
+            dist = std::min(dist, lhs[j] + Table::distance(rhs, i - j));
+            dist = std::min(dist, lhs[i - j] + Table::distance(rhs, j));
         }
         lhs[i] = dist;
     }
 
     for (int i = m; i >= 0; --i) {
-        int32_t dist = lhs[i] + rhs[0];
+        int32_t dist = lhs[i] + Table::distance(rhs, 0);
         for (int j = 0; j < i; ++j) {
-            dist = std::min(dist, lhs[j] + rhs[i - j]);
+            dist = std::min(dist, lhs[j] + Table::distance(rhs, i - j));
         }
         lhs[i] = dist;
     }
@@ -195,10 +475,11 @@ void ShantenCalculator::add1(ResultType &lhs, const Table::TableType &rhs, const
 void ShantenCalculator::add2(ResultType &lhs, const Table::TableType &rhs, const int m)
 {
     int i = m + 5;
-    int32_t dist = std::min(lhs[i] + rhs[0], lhs[0] + rhs[i]);
+    int32_t dist =
+        std::min(lhs[i] + Table::distance(rhs, 0), lhs[0] + Table::distance(rhs, i));
     for (int j = 5; j < i; ++j) {
-        dist = std::min(dist, lhs[j] + rhs[i - j]);
-        dist = std::min(dist, lhs[i - j] + rhs[j]);
+        dist = std::min(dist, lhs[j] + Table::distance(rhs, i - j));
+        dist = std::min(dist, lhs[i - j] + Table::distance(rhs, j));
     }
     lhs[i] = dist;
 }
@@ -4,12 +4,11 @@
 #include <array>
 #include <cstdint>
 #include <tuple>
+#include <vector>
 
 #include "mahjong/core/table.hpp"
 #include "mahjong/types/types.hpp"
 
-//#define USE_NYANTEN_TABLE
-
 namespace mahjong
 {
 
@@ -23,9 +22,17 @@ class ShantenCalculator
   public:
     static std::tuple<int, int> calc(const Hand &hand, const int num_melds, int type,
                                      int game_mode);
+    static void calc_batch(const Hand *hands, size_t num_hands, int num_melds, int type,
+                           int game_mode, std::tuple<int, int> *results);
+    static std::vector<std::tuple<int, int>> calc_batch(const std::vector<Hand> &hands,
+                                                        int num_melds, int type,
+                                                        int game_mode);
 
   private:
     template <int Mode> static int calc_regular(const Hand &hand, const int num_melds);
+    template <int Mode>
+    static void calc_regular_batch(const Hand *hands, size_t num_hands, int num_melds,
+                                   int *shanten);
     template <int Mode> static int calc_seven_pairs(const Hand &hand);
     static int calc_thirteen_orphans(const Hand &hand);
     static void add1(ResultType &lhs, const Table::TableType &rhs, const int m);
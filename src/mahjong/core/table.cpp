@@ -1,13 +1,96 @@
 #include "table.hpp"
 
+#include <cstdlib> // getenv
+#include <cstring> // memcpy
+#include <stdexcept>
+
 #include <boost/dll.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+#ifdef EMBED_SHANTEN_TABLE
+#if defined(__APPLE__)
+#define MAHJONG_EMBED_SECTION ".const_data"
+#define MAHJONG_EMBED_SYMBOL(name) "_" #name
+#else
+#define MAHJONG_EMBED_SECTION ".section .rodata"
+#define MAHJONG_EMBED_SYMBOL(name) #name
+#endif
+
+// Embeds a mapped table file generated at build time as read-only data.
+#define MAHJONG_EMBED_TABLE(name, filepath)                                          \
+    __asm__(MAHJONG_EMBED_SECTION "\n"                                               \
+            ".balign 64\n"                                                           \
+            ".global " MAHJONG_EMBED_SYMBOL(name##_begin) "\n"                       \
+            MAHJONG_EMBED_SYMBOL(name##_begin) ":\n"                                 \
+            ".incbin \"" filepath "\"\n"                                             \
+            ".global " MAHJONG_EMBED_SYMBOL(name##_end) "\n"                         \
+            MAHJONG_EMBED_SYMBOL(name##_end) ":\n"                                   \
+            ".text\n");
+
+MAHJONG_EMBED_TABLE(mahjong_suits_table, MAHJONG_SUITS_TABLE_FILE)
+MAHJONG_EMBED_TABLE(mahjong_honors_table, MAHJONG_HONORS_TABLE_FILE)
+
+extern "C" const char mahjong_suits_table_begin[];
+extern "C" const char mahjong_suits_table_end[];
+extern "C" const char mahjong_honors_table_begin[];
+extern "C" const char mahjong_honors_table_end[];
+#endif
 
 namespace mahjong
 {
 
+namespace
+{
+
+/**
+ * @brief Converts a (distance, wait, discard) entry to the table entry type.
+ *
+ * @param values Elements [0, 10) are distances, [10, 20) are waits and [20, 30) are
+ *               discards.
+ * @return The table entry
+ */
+constexpr Table::TableType to_table_entry(const std::array<int32_t, 30> &values)
+{
+#ifdef USE_PACKED_TABLE
+    Table::TableType entry{};
+    for (size_t i = 0; i < 10; ++i) {
+        entry[i] = static_cast<uint32_t>(values[i] | (values[i + 10] << 4) |
+                                         (values[i + 20] << 13));
+    }
+    return entry;
+#else
+    return values;
+#endif
+}
+
+// Regions of the mapped table files. They must outlive the tables pointing into them.
+std::vector<boost::interprocess::mapped_region> mapped_regions;
+
+// Tables loaded from the legacy table files.
+std::vector<Table::TableType> suits_table_storage;
+std::vector<Table::TableType> honors_table_storage;
+
+/**
+ * @brief Returns whether the checksums of the mapped table files are verified.
+ *        Verifying reads every page of the tables, so it is enabled only when the
+ *        environment variable MAHJONG_CPP_VERIFY_TABLES is set to a value other than 0.
+ */
+bool verify_checksum()
+{
+    const char *value = std::getenv("MAHJONG_CPP_VERIFY_TABLES");
+    return value && *value && std::strcmp(value, "0") != 0;
+}
+
+} // namespace
+
 Table::Table()
 {
-    initialize();
+#ifndef NO_SHANTEN_TABLE_AUTOLOAD
+    if (!initialize()) {
+        throw std::runtime_error("Failed to load shanten tables.");
+    }
+#endif
 }
 
 /**
@@ -17,72 +100,206 @@ Table::Table()
  */
 bool Table::initialize()
 {
+#ifdef EMBED_SHANTEN_TABLE
+    // The embedded tables are produced by the same build, so only the header is
+    // checked.
+    suits_table_ = validate_table(
+        mahjong_suits_table_begin, mahjong_suits_table_end - mahjong_suits_table_begin,
+        SuitsTableSize, "embedded suits table", false);
+    honors_table_ = validate_table(
+        mahjong_honors_table_begin,
+        mahjong_honors_table_end - mahjong_honors_table_begin, HonorsTableSize,
+        "embedded honors table", false);
+
+    return suits_table_ && honors_table_;
+#else
     boost::filesystem::path exe_path = boost::dll::program_location().parent_path();
 #ifdef USE_NYANTEN_TABLE
-    boost::filesystem::path suits_table_path = exe_path / "suits_table_nyanten.bin";
-    boost::filesystem::path honors_table_path = exe_path / "honors_table_nyanten.bin";
+    const std::string suits_table_name = "suits_table_nyanten";
+    const std::string honors_table_name = "honors_table_nyanten";
 #else
-    boost::filesystem::path suits_table_path = exe_path / "suits_table.bin";
-    boost::filesystem::path honors_table_path = exe_path / "honors_table.bin";
+    const std::string suits_table_name = "suits_table";
+    const std::string honors_table_name = "honors_table";
 #endif
 
-    return load_table(suits_table_path.string(), suits_table_) &&
-           load_table(honors_table_path.string(), honors_table_);
+    // Use the mapped table files if they exist, otherwise load the table files.
+    const auto load = [&](const std::string &name, const size_t table_size,
+                          const TableType *&table, std::vector<TableType> &storage) {
+        const boost::filesystem::path mapped_path = exe_path / (name + ".map");
+        if (boost::filesystem::exists(mapped_path) &&
+            map_table(mapped_path.string(), table_size, table)) {
+            return true;
+        }
+
+        const boost::filesystem::path path = exe_path / (name + ".bin");
+        if (!load_table(path.string(), table_size, storage)) {
+            return false;
+        }
+        table = storage.data();
+
+        return true;
+    };
+
+    return load(suits_table_name, SuitsTableSize, suits_table_, suits_table_storage) &&
+           load(honors_table_name, HonorsTableSize, honors_table_,
+                honors_table_storage);
+#endif
+}
+
+/**
+ * @brief Maps a mapped table file into memory.
+ *        The pages are shared with other processes mapping the same file.
+ *
+ * @param filepath The path to the mapped table file.
+ * @param table_size The size of the table.
+ * @param table The pointer to be set to the mapped table.
+ * @return true if the table is mapped and validated successfully; false otherwise.
+ */
+bool Table::map_table(const std::string &filepath, const size_t table_size,
+                      const TableType *&table)
+{
+    namespace bip = boost::interprocess;
+
+    bip::mapped_region region;
+    try {
+        const bip::file_mapping file(filepath.c_str(), bip::read_only);
+        region = bip::mapped_region(file, bip::read_only);
+    }
+    catch (const bip::interprocess_exception &e) {
+        spdlog::error(u8"Failed to map table file. (path: {}, error: {})", filepath,
+                      e.what());
+        return false;
+    }
+
+    const auto entries = validate_table(static_cast<const char *>(region.get_address()),
+                                        region.get_size(), table_size, filepath,
+                                        verify_checksum());
+    if (!entries) {
+        return false;
+    }
+
+    table = entries;
+    mapped_regions.push_back(std::move(region));
+
+    spdlog::info(u8"Table file mapped. (path: {}, size: {})", filepath, table_size);
+
+    return true;
+}
+
+/**
+ * @brief Validates the header of mapped table data, and the checksum if requested.
+ *        The header check covers the layout and the size, and touches only the
+ *        first page, so the entries are still paged in lazily.
+ *
+ * @param data The mapped table data starting with the header.
+ * @param size The size of the data in bytes.
+ * @param table_size The size of the table.
+ * @param name The name of the data used in log messages.
+ * @param verify Whether to verify the checksum of all entries.
+ * @return The table entries if the data is valid; nullptr otherwise.
+ */
+const Table::TableType *Table::validate_table(const char *data, const size_t size,
+                                              const size_t table_size,
+                                              const std::string &name,
+                                              const bool verify)
+{
+    if (size < sizeof(MappedTableHeader)) {
+        spdlog::error(u8"Invalid table file header. (path: {})", name);
+        return nullptr;
+    }
+
+    MappedTableHeader header;
+    std::memcpy(&header, data, sizeof(header));
+    if (header.magic != MappedTableMagic || header.version != MappedTableVersion ||
+        header.flags != MappedTableFlags || header.entry_size != sizeof(TableType) ||
+        header.table_size != table_size ||
+        size != sizeof(header) + table_size * sizeof(TableType)) {
+        spdlog::error(u8"Incompatible table file. (path: {}, version: {}, flags: {})",
+                      name, header.version, header.flags);
+        return nullptr;
+    }
+
+    const auto entries = reinterpret_cast<const TableType *>(data + sizeof(header));
+    if (verify && header.checksum != checksum(entries, table_size)) {
+        spdlog::error(u8"Table file checksum mismatch. (path: {})", name);
+        return nullptr;
+    }
+
+    return entries;
+}
+
+/**
+ * @brief Computes the checksum of the table entries (64-bit FNV-1a over 32-bit words).
+ *
+ * @param table The table entries.
+ * @param table_size The size of the table.
+ * @return The checksum
+ */
+uint64_t Table::checksum(const TableType *table, const size_t table_size)
+{
+    uint64_t hash = 0xcbf29ce484222325ull;
+    for (size_t i = 0; i < table_size; ++i) {
+        for (const auto value : table[i]) {
+            hash = (hash ^ static_cast<uint32_t>(value)) * 0x100000001b3ull;
+        }
+    }
+
+    return hash;
 }
 
-std::array<Table::TableType, Table::SuitsTableSize> Table::suits_table_;
-std::array<Table::TableType, Table::HonorsTableSize> Table::honors_table_;
+const Table::TableType *Table::suits_table_;
+const Table::TableType *Table::honors_table_;
 std::array<Table::TableType, Table::SanmaManzuTableSize> Table::sanma_manzu_table_ = {{
-    Table::TableType{{0,   3,   6, 15, 15, 2, 5, 15, 15, 15, 0, 257, 257, 0, 0,
-                      257, 257, 0, 0,  0,  0, 0, 0,  0,  0,  0, 0,   0,   0, 0}},
-    Table::TableType{{0,   2,   5, 15, 15, 1,   4, 15, 15, 15, 0, 256, 257, 0, 0,
-                      256, 257, 0, 0,  0,  256, 0, 0,  0,  0,  0, 0,   0,   0, 0}},
-    Table::TableType{{0, 1,   4, 15, 15, 0,   3, 15, 15, 15, 0, 256, 257, 0, 0,
-                      0, 257, 0, 0,  0,  256, 0, 0,  0,  0,  0, 0,   0,   0, 0}},
-    Table::TableType{{0, 0, 3, 15, 15, 0,   2, 15, 15, 15, 0,   0, 1, 0, 0,
-                      0, 1, 0, 0,  0,  256, 0, 0,  0,  0,  256, 0, 0, 0, 0}},
-    Table::TableType{{0, 0, 3, 15, 15, 0,   2,   15,  15, 15, 0,   0,   1, 0, 0,
-                      0, 1, 0, 0,  0,  256, 256, 256, 0,  0,  256, 256, 0, 0, 0}},
-    Table::TableType{{0, 2,   5, 15, 15, 1, 4, 15, 15, 15, 0, 1, 257, 0, 0,
-                      1, 257, 0, 0,  0,  1, 0, 0,  0,  0,  0, 0, 0,   0, 0}},
-    Table::TableType{{0,   2,   4, 15, 15, 1,   3,   15, 15, 15, 0,   257, 257, 0, 0,
-                      257, 257, 0, 0,  0,  257, 257, 0,  0,  0,  257, 0,   0,   0, 0}},
-    Table::TableType{{0, 1,   3, 15, 15, 0,   2, 15, 15, 15, 0, 256, 257, 0, 0,
-                      0, 257, 0, 0,  0,  257, 1, 0,  0,  0,  1, 0,   0,   0, 0}},
-    Table::TableType{{0, 0, 2, 15, 15, 0,   1, 15, 15, 15, 0,   0, 1, 0, 0,
-                      0, 1, 0, 0,  0,  257, 1, 0,  0,  0,  257, 0, 0, 0, 0}},
-    Table::TableType{{0, 0, 2, 15, 15, 0,   1,   15,  15, 15, 0,   0,   1, 0, 0,
-                      0, 1, 0, 0,  0,  257, 257, 256, 0,  0,  257, 256, 0, 0, 0}},
-    Table::TableType{{0, 1,   4, 15, 15, 0, 3, 15, 15, 15, 0, 1, 257, 0, 0,
-                      0, 257, 0, 0,  0,  1, 0, 0,  0,  0,  0, 0, 0,   0, 0}},
-    Table::TableType{{0, 1,   3, 15, 15, 0,   2,   15, 15, 15, 0,   1, 257, 0, 0,
-                      0, 257, 0, 0,  0,  257, 256, 0,  0,  0,  256, 0, 0,   0, 0}},
-    Table::TableType{{0, 1,   2, 15, 15, 0,   1,   15, 15, 15, 0,   257, 257, 0, 0,
-                      0, 257, 0, 0,  0,  257, 257, 0,  0,  0,  257, 0,   0,   0, 0}},
-    Table::TableType{{0, 0, 1, 15, 15, 0,   0, 15, 15, 15, 0,   0, 1, 0, 0,
-                      0, 0, 0, 0,  0,  257, 1, 0,  0,  0,  257, 0, 0, 0, 0}},
-    Table::TableType{{0, 0, 1, 15, 15, 0,   0,   15,  15, 15, 0,   0,   1, 0, 0,
-                      0, 0, 0, 0,  0,  257, 257, 256, 0,  0,  257, 256, 0, 0, 0}},
-    Table::TableType{{0, 0,   3, 15, 15, 0, 2, 15, 15, 15, 0, 0, 256, 0, 0,
-                      0, 256, 0, 0,  0,  1, 0, 0,  0,  0,  1, 0, 0,   0, 0}},
-    Table::TableType{{0, 0,   2, 15, 15, 0,   1,   15, 15, 15, 0,   0, 256, 0, 0,
-                      0, 256, 0, 0,  0,  257, 256, 0,  0,  0,  257, 0, 0,   0, 0}},
-    Table::TableType{{0, 0, 1, 15, 15, 0,   0,   15, 15, 15, 0,   0, 256, 0, 0,
-                      0, 0, 0, 0,  0,  257, 256, 0,  0,  0,  257, 0, 0,   0, 0}},
-    Table::TableType{{0, 0, 0, 15, 15, 0,   0,   15, 15, 15, 0,   0,   0, 0, 0,
-                      0, 0, 0, 0,  0,  257, 257, 0,  0,  0,  257, 257, 0, 0, 0}},
-    Table::TableType{{0, 0, 0, 15, 15, 0,   0,   15,  15, 15, 0,   0,   0, 0, 0,
-                      0, 0, 0, 0,  0,  257, 257, 256, 0,  0,  257, 257, 0, 0, 0}},
-    Table::TableType{{0, 0,   3, 15, 15, 0, 2, 15, 15, 15, 0, 0, 256, 0, 0,
-                      0, 256, 0, 0,  0,  1, 1, 1,  0,  0,  1, 1, 0,   0, 0}},
-    Table::TableType{{0, 0,   2, 15, 15, 0,   1,   15, 15, 15, 0,   0, 256, 0, 0,
-                      0, 256, 0, 0,  0,  257, 257, 1,  0,  0,  257, 1, 0,   0, 0}},
-    Table::TableType{{0, 0, 1, 15, 15, 0,   0,   15, 15, 15, 0,   0, 256, 0, 0,
-                      0, 0, 0, 0,  0,  257, 257, 1,  0,  0,  257, 1, 0,   0, 0}},
-    Table::TableType{{0, 0, 0, 15, 15, 0,   0,   15, 15, 15, 0,   0,   0, 0, 0,
-                      0, 0, 0, 0,  0,  257, 257, 1,  0,  0,  257, 257, 0, 0, 0}},
-    Table::TableType{{0, 0, 0, 15, 15, 0,   0,   15,  15, 15, 0,   0,   0, 0, 0,
-                      0, 0, 0, 0,  0,  257, 257, 257, 0,  0,  257, 257, 0, 0, 0}},
+    to_table_entry({{0,   3,   6, 15, 15, 2, 5, 15, 15, 15, 0, 257, 257, 0, 0,
+                      257, 257, 0, 0,  0,  0, 0, 0,  0,  0,  0, 0,   0,   0, 0}}),
+    to_table_entry({{0,   2,   5, 15, 15, 1,   4, 15, 15, 15, 0, 256, 257, 0, 0,
+                      256, 257, 0, 0,  0,  256, 0, 0,  0,  0,  0, 0,   0,   0, 0}}),
+    to_table_entry({{0, 1,   4, 15, 15, 0,   3, 15, 15, 15, 0, 256, 257, 0, 0,
+                      0, 257, 0, 0,  0,  256, 0, 0,  0,  0,  0, 0,   0,   0, 0}}),
+    to_table_entry({{0, 0, 3, 15, 15, 0,   2, 15, 15, 15, 0,   0, 1, 0, 0,
+                      0, 1, 0, 0,  0,  256, 0, 0,  0,  0,  256, 0, 0, 0, 0}}),
+    to_table_entry({{0, 0, 3, 15, 15, 0,   2,   15,  15, 15, 0,   0,   1, 0, 0,
+                      0, 1, 0, 0,  0,  256, 256, 256, 0,  0,  256, 256, 0, 0, 0}}),
+    to_table_entry({{0, 2,   5, 15, 15, 1, 4, 15, 15, 15, 0, 1, 257, 0, 0,
+                      1, 257, 0, 0,  0,  1, 0, 0,  0,  0,  0, 0, 0,   0, 0}}),
+    to_table_entry({{0,   2,   4, 15, 15, 1,   3,   15, 15, 15, 0,   257, 257, 0, 0,
+                      257, 257, 0, 0,  0,  257, 257, 0,  0,  0,  257, 0,   0,   0, 0}}),
+    to_table_entry({{0, 1,   3, 15, 15, 0,   2, 15, 15, 15, 0, 256, 257, 0, 0,
+                      0, 257, 0, 0,  0,  257, 1, 0,  0,  0,  1, 0,   0,   0, 0}}),
+    to_table_entry({{0, 0, 2, 15, 15, 0,   1, 15, 15, 15, 0,   0, 1, 0, 0,
+                      0, 1, 0, 0,  0,  257, 1, 0,  0,  0,  257, 0, 0, 0, 0}}),
+    to_table_entry({{0, 0, 2, 15, 15, 0,   1,   15,  15, 15, 0,   0,   1, 0, 0,
+                      0, 1, 0, 0,  0,  257, 257, 256, 0,  0,  257, 256, 0, 0, 0}}),
+    to_table_entry({{0, 1,   4, 15, 15, 0, 3, 15, 15, 15, 0, 1, 257, 0, 0,
+                      0, 257, 0, 0,  0,  1, 0, 0,  0,  0,  0, 0, 0,   0, 0}}),
+    to_table_entry({{0, 1,   3, 15, 15, 0,   2,   15, 15, 15, 0,   1, 257, 0, 0,
+                      0, 257, 0, 0,  0,  257, 256, 0,  0,  0,  256, 0, 0,   0, 0}}),
+    to_table_entry({{0, 1,   2, 15, 15, 0,   1,   15, 15, 15, 0,   257, 257, 0, 0,
+                      0, 257, 0, 0,  0,  257, 257, 0,  0,  0,  257, 0,   0,   0, 0}}),
+    to_table_entry({{0, 0, 1, 15, 15, 0,   0, 15, 15, 15, 0,   0, 1, 0, 0,
+                      0, 0, 0, 0,  0,  257, 1, 0,  0,  0,  257, 0, 0, 0, 0}}),
+    to_table_entry({{0, 0, 1, 15, 15, 0,   0,   15,  15, 15, 0,   0,   1, 0, 0,
+                      0, 0, 0, 0,  0,  257, 257, 256, 0,  0,  257, 256, 0, 0, 0}}),
+    to_table_entry({{0, 0,   3, 15, 15, 0, 2, 15, 15, 15, 0, 0, 256, 0, 0,
+                      0, 256, 0, 0,  0,  1, 0, 0,  0,  0,  1, 0, 0,   0, 0}}),
+    to_table_entry({{0, 0,   2, 15, 15, 0,   1,   15, 15, 15, 0,   0, 256, 0, 0,
+                      0, 256, 0, 0,  0,  257, 256, 0,  0,  0,  257, 0, 0,   0, 0}}),
+    to_table_entry({{0, 0, 1, 15, 15, 0,   0,   15, 15, 15, 0,   0, 256, 0, 0,
+                      0, 0, 0, 0,  0,  257, 256, 0,  0,  0,  257, 0, 0,   0, 0}}),
+    to_table_entry({{0, 0, 0, 15, 15, 0,   0,   15, 15, 15, 0,   0,   0, 0, 0,
+                      0, 0, 0, 0,  0,  257, 257, 0,  0,  0,  257, 257, 0, 0, 0}}),
+    to_table_entry({{0, 0, 0, 15, 15, 0,   0,   15,  15, 15, 0,   0,   0, 0, 0,
+                      0, 0, 0, 0,  0,  257, 257, 256, 0,  0,  257, 257, 0, 0, 0}}),
+    to_table_entry({{0, 0,   3, 15, 15, 0, 2, 15, 15, 15, 0, 0, 256, 0, 0,
+                      0, 256, 0, 0,  0,  1, 1, 1,  0,  0,  1, 1, 0,   0, 0}}),
+    to_table_entry({{0, 0,   2, 15, 15, 0,   1,   15, 15, 15, 0,   0, 256, 0, 0,
+                      0, 256, 0, 0,  0,  257, 257, 1,  0,  0,  257, 1, 0,   0, 0}}),
+    to_table_entry({{0, 0, 1, 15, 15, 0,   0,   15, 15, 15, 0,   0, 256, 0, 0,
+                      0, 0, 0, 0,  0,  257, 257, 1,  0,  0,  257, 1, 0,   0, 0}}),
+    to_table_entry({{0, 0, 0, 15, 15, 0,   0,   15, 15, 15, 0,   0,   0, 0, 0,
+                      0, 0, 0, 0,  0,  257, 257, 1,  0,  0,  257, 257, 0, 0, 0}}),
+    to_table_entry({{0, 0, 0, 15, 15, 0,   0,   15,  15, 15, 0,   0,   0, 0, 0,
+                      0, 0, 0, 0,  0,  257, 257, 257, 0,  0,  257, 257, 0, 0, 0}}),
 }};
 
 static Table inst;
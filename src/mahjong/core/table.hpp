@@ -7,13 +7,12 @@
 #include <iterator>
 #include <numeric> // accumulate
 #include <string>
+#include <vector>
 
 #include <spdlog/spdlog.h>
 
 #include "nyanten_table.hpp"
 
-//#define USE_NYANTEN_TABLE
-
 namespace mahjong
 {
 
@@ -24,31 +23,79 @@ namespace mahjong
  */
 class Table
 {
+  public:
     // The table size is defined as the maximum hash value + 1.
+#ifdef USE_NYANTEN_TABLE
+    static constexpr size_t SuitsTableSize = 405350;
+    static constexpr size_t HonorsTableSize = 43130;
+#else
     static constexpr size_t SuitsTableSize = 1943751;
     static constexpr size_t HonorsTableSize = 77751;
+#endif
     static constexpr size_t SanmaManzuTableSize = 25;
 
-  public:
+#ifdef USE_PACKED_TABLE
+    // Each element packs distance (4 bits), wait (9 bits) and discard (9 bits)
+    // in the same form as the table file.
+    using TableType = std::array<uint32_t, 10>;
+#else
+    // Elements [0, 10) are distances, [10, 20) are waits and [20, 30) are discards.
     using TableType = std::array<int32_t, 30>;
+#endif
     using HashType = int32_t;
 
+    /**
+     * @brief The header of a mapped table file.
+     *        The header is followed by the table entries of the table size,
+     *        laid out in native byte order exactly as they are used in memory.
+     */
+    struct MappedTableHeader
+    {
+        std::array<char, 8> magic;
+        uint32_t version;
+        uint32_t flags;
+        uint32_t entry_size;
+        uint32_t reserved;
+        uint64_t table_size;
+        uint64_t checksum;
+    };
+    static constexpr std::array<char, 8> MappedTableMagic = {'M', 'J', 'C', 'P',
+                                                             'P', 'T', 'B', 'L'};
+    static constexpr uint32_t MappedTableVersion = 1;
+    static constexpr uint32_t MappedTableFlags =
+#ifdef USE_PACKED_TABLE
+        0b01 |
+#endif
+#ifdef USE_NYANTEN_TABLE
+        0b10 |
+#endif
+        0b00;
+
     Table();
     template <typename ForwardIterator>
     static HashType suits_hash(ForwardIterator first, ForwardIterator last);
     static HashType sanma_manzu_hash(int manzu1_count, int manzu9_count);
     template <typename ForwardIterator>
     static HashType honors_hash(ForwardIterator first, ForwardIterator last);
+    static int32_t distance(const TableType &entry, int i);
+    static int32_t wait(const TableType &entry, int i);
+    static int32_t discard(const TableType &entry, int i);
+    static void set_entry(TableType &entry, int i, uint32_t value);
+    static uint64_t checksum(const TableType *table, size_t table_size);
 
   private:
     static bool initialize();
-    template <size_t TableSize>
-    static bool load_table(const std::string &filepath,
-                           std::array<TableType, TableSize> &table);
+    static bool map_table(const std::string &filepath, size_t table_size,
+                          const TableType *&table);
+    static const TableType *validate_table(const char *data, size_t size,
+                                           size_t table_size, const std::string &name,
+                                           bool verify);
+    static bool load_table(const std::string &filepath, size_t table_size,
+                           std::vector<TableType> &table);
 
   public:
-    static std::array<TableType, SuitsTableSize> suits_table_;
-    static std::array<TableType, HonorsTableSize> honors_table_;
+    static const TableType *suits_table_;
+    static const TableType *honors_table_;
     static std::array<TableType, SanmaManzuTableSize> sanma_manzu_table_;
 };
 
@@ -123,17 +170,82 @@ inline Table::HashType Table::honors_hash(ForwardIterator first, ForwardIterator
 #endif
 }
 
+/**
+ * @brief Returns the distance of the i-th element of the table entry.
+ *
+ * @param entry The table entry.
+ * @param i The element index in [0, 10).
+ * @return The distance
+ */
+inline int32_t Table::distance(const TableType &entry, const int i)
+{
+#ifdef USE_PACKED_TABLE
+    return static_cast<int32_t>(entry[i] & 0b1111);
+#else
+    return entry[i];
+#endif
+}
+
+/**
+ * @brief Returns the wait flags of the i-th element of the table entry.
+ *
+ * @param entry The table entry.
+ * @param i The element index in [0, 10).
+ * @return The wait flags
+ */
+inline int32_t Table::wait(const TableType &entry, const int i)
+{
+#ifdef USE_PACKED_TABLE
+    return static_cast<int32_t>((entry[i] >> 4) & 0b111111111);
+#else
+    return entry[i + 10];
+#endif
+}
+
+/**
+ * @brief Returns the discard flags of the i-th element of the table entry.
+ *
+ * @param entry The table entry.
+ * @param i The element index in [0, 10).
+ * @return The discard flags
+ */
+inline int32_t Table::discard(const TableType &entry, const int i)
+{
+#ifdef USE_PACKED_TABLE
+    return static_cast<int32_t>((entry[i] >> 13) & 0b111111111);
+#else
+    return entry[i + 20];
+#endif
+}
+
+/**
+ * @brief Stores the i-th value of the table file in the table entry.
+ *
+ * @param entry The table entry.
+ * @param i The element index in [0, 10).
+ * @param value The value packing distance, wait and discard.
+ */
+inline void Table::set_entry(TableType &entry, const int i, const uint32_t value)
+{
+#ifdef USE_PACKED_TABLE
+    entry[i] = value;
+#else
+    entry[i] = value & 0b1111;                   // distance
+    entry[i + 10] = (value >> 4) & 0b111111111;  // wait
+    entry[i + 20] = (value >> 13) & 0b111111111; // discard
+#endif
+}
+
 /**
  * @brief Loads precalculated data from a file into a table.
  *
- * @tparam TableSize The size of the table.
  * @param filepath The path to the file containing the table data.
+ * @param table_size The size of the table.
  * @param table The table to be populated with the data.
  * @return true if the table is loaded successfully; false otherwise.
  */
-template <size_t TableSize>
-bool Table::load_table(const std::string &filepath,
-                       std::array<TableType, TableSize> &table)
+inline bool Table::load_table(const std::string &filepath, const size_t table_size,
+                              std::vector<TableType> &table)
 {
     std::ifstream file(filepath, std::ios::binary);
     if (!file) {
@@ -141,13 +253,15 @@ bool Table::load_table(const std::string &filepath,
         return false;
     }
 
+    table.assign(table_size, TableType{});
+
     while (file) {
         HashType key;
         uint32_t value;
         if (!file.read(reinterpret_cast<char *>(&key), sizeof(key))) {
             break;
         }
-        if (key < 0 || static_cast<size_t>(key) >= TableSize) {
+        if (key < 0 || static_cast<size_t>(key) >= table_size) {
             spdlog::error(u8"Invalid table key. (path: {}, key: {})", filepath, key);
             return false;
         }
@@ -156,9 +270,7 @@ bool Table::load_table(const std::string &filepath,
                 spdlog::error(u8"Failed to read table file. (path: {})", filepath);
                 return false;
             }
-            table[key][i] = value & 0b1111;                   // distance
-            table[key][i + 10] = (value >> 4) & 0b111111111;  // wait
-            table[key][i + 20] = (value >> 13) & 0b111111111; // discard
+            set_entry(table[key], static_cast<int>(i), value);
         }
     }
 
@@ -160,8 +160,11 @@ std::tuple<int, int64_t> UnnecessaryTileCalculator::calc_regular(const Hand &han
 
     int m = 4 - num_melds;
 
-    ResultType ret;
-    std::copy(honors.begin(), honors.end(), ret.begin());
+    ResultType ret{};
+    for (int i = 0; i < 10; ++i) {
+        ret[i] = Table::distance(honors, i);
+        ret[i + 20] = Table::discard(honors, i);
+    }
     add1(ret, souzu, m);
     add1(ret, pinzu, m);
     add2(ret, manzu, m);
@@ -278,16 +281,18 @@ void UnnecessaryTileCalculator::add1(ResultType &lhs, const Table::TableType &rh
                                      const int m)
 {
     auto lhs2 = &lhs[20];
-    const auto rhs2 = &rhs[20];
 
     for (int i = m + 5; i >= 5; --i) {
-        ResultType::value_type dist = lhs[i] + rhs[0];
-        ResultType::value_type disc = (lhs2[i] << 9) | rhs2[0];
-        shift(dist, lhs[0] + rhs[i], disc, (lhs2[0] << 9) | rhs2[i]);
+        ResultType::value_type dist = lhs[i] + Table::distance(rhs, 0);
+        ResultType::value_type disc = (lhs2[i] << 9) | Table::discard(rhs, 0);
+        shift(dist, lhs[0] + Table::distance(rhs, i), disc,
+              (lhs2[0] << 9) | Table::discard(rhs, i));
 
         for (int j = 5; j < i; ++j) {
-            shift(dist, lhs[j] + rhs[i - j], disc, (lhs2[j] << 9) | rhs2[i - j]);
-            shift(dist, lhs[i - j] + rhs[j], disc, (lhs2[i - j] << 9) | rhs2[j]);
+            shift(dist, lhs[j] + Table::distance(rhs, i - j), disc,
+                  (lhs2[j] << 9) | Table::discard(rhs, i - j));
+            shift(dist, lhs[i - j] + Table::distance(rhs, j), disc,
+                  (lhs2[i - j] << 9) | Table::discard(rhs, j));
         }
 
         lhs[i] = dist;
@@ -295,11 +300,12 @@ void UnnecessaryTileCalculator::add1(ResultType &lhs, const Table::TableType &rh
     }
 
     for (int i = m; i >= 0; --i) {
-        ResultType::value_type dist = lhs[i] + rhs[0];
-        ResultType::value_type disc = (lhs2[i] << 9) | rhs2[0];
+        ResultType::value_type dist = lhs[i] + Table::distance(rhs, 0);
+        ResultType::value_type disc = (lhs2[i] << 9) | Table::discard(rhs, 0);
 
         for (int j = 0; j < i; ++j) {
-            shift(dist, lhs[j] + rhs[i - j], disc, (lhs2[j] << 9) | rhs2[i - j]);
+            shift(dist, lhs[j] + Table::distance(rhs, i - j), disc,
+                  (lhs2[j] << 9) | Table::discard(rhs, i - j));
         }
 
         lhs[i] = dist;
@@ -311,15 +317,17 @@ void UnnecessaryTileCalculator::add2(ResultType &lhs, const Table::TableType &rh
                                      const int m)
 {
     auto lhs2 = &lhs[20];
-    const auto rhs2 = &rhs[20];
 
     int i = m + 5;
-    ResultType::value_type dist = lhs[i] + rhs[0];
-    ResultType::value_type disc = (lhs2[i] << 9) | rhs2[0];
-    shift(dist, lhs[0] + rhs[i], disc, (lhs2[0] << 9) | rhs2[i]);
+    ResultType::value_type dist = lhs[i] + Table::distance(rhs, 0);
+    ResultType::value_type disc = (lhs2[i] << 9) | Table::discard(rhs, 0);
+    shift(dist, lhs[0] + Table::distance(rhs, i), disc,
+          (lhs2[0] << 9) | Table::discard(rhs, i));
     for (int j = 5; j < i; ++j) {
-        shift(dist, lhs[j] + rhs[i - j], disc, (lhs2[j] << 9) | rhs2[i - j]);
-        shift(dist, lhs[i - j] + rhs[j], disc, (lhs2[i - j] << 9) | rhs2[j]);
+        shift(dist, lhs[j] + Table::distance(rhs, i - j), disc,
+              (lhs2[j] << 9) | Table::discard(rhs, i - j));
+        shift(dist, lhs[i - j] + Table::distance(rhs, j), disc,
+              (lhs2[i - j] << 9) | Table::discard(rhs, j));
     }
 
     lhs[i] = dist;
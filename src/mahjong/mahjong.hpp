@@ -2,6 +2,8 @@
 #define MAHJONG_CPP_MAHJONG
 
 #include "mahjong/core/expected_score_calculator.hpp"
+#include "mahjong/core/hand_analyzer.hpp"
+#include "mahjong/core/incremental_tile_calculator.hpp"
 #include "mahjong/core/necessary_tile_calculator.hpp"
 #include "mahjong/core/score_calculator.hpp"
 #include "mahjong/core/shanten_calculator.hpp"
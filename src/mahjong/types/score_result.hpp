@@ -1,6 +1,7 @@
 #ifndef MAHJONG_CPP_SCORE_RESULT_HPP
 #define MAHJONG_CPP_SCORE_RESULT_HPP
 
+#include <array>
 #include <string>
 #include <vector>
 
@@ -55,6 +56,36 @@ struct ScoreResult
     int wait_type = WaitType::Null;
 };
 
+/**
+ * @brief Score calculation result without heap-allocated members.
+ */
+struct ScoreSummary
+{
+    /*! Whether the calculation succeeded. */
+    bool success = false;
+
+    /*! Established yaku. */
+    YakuFlags yaku_list = Yaku::None;
+
+    /*! Total han. */
+    int han = 0;
+
+    /*! Total fu. */
+    int fu = 0;
+
+    /*! Score limit. */
+    int score_limit = ScoreLimit::Null;
+
+    /*! Winner gain followed by payer payments. */
+    std::array<int, 3> payments{};
+
+    /*! Number of valid entries in payments. */
+    int num_payments = 0;
+
+    /*! Wait type. */
+    int wait_type = WaitType::Null;
+};
+
 } // namespace mahjong
 
 #endif // MAHJONG_CPP_SCORE_RESULT_HPP
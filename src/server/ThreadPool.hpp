@@ -1,7 +1,11 @@
 #ifndef THREAD_POOL_H
 #define THREAD_POOL_H
 
+#include <algorithm>
+#include <array>
+#include <chrono>
 #include <condition_variable>
+#include <cstdint>
 #include <functional>
 #include <future>
 #include <limits>
@@ -21,11 +25,32 @@ class ThreadPoolQueueFull : public std::runtime_error
     }
 };
 
+// Each task has a cost (1 by default), and a task is rejected when the total cost of
+// the waiting tasks would exceed max_waiting_cost. A task is always accepted when no
+// task is waiting, so that a task more expensive than the limit can still run.
+//
+// Waiting tasks are queued in lanes, and lane 0 has the highest priority. A worker
+// takes the oldest task of the highest-priority lane, but a lane that has been
+// bypassed MaxBypassed times in a row goes first, so that no lane starves.
 class ThreadPool
 {
   public:
+    static constexpr size_t NumLanes = 3;
+    static constexpr size_t MaxBypassed = 4;
+
+    struct LaneStats
+    {
+        size_t waiting_tasks = 0;
+        uint64_t enqueued = 0;
+        uint64_t rejected = 0;
+        uint64_t started = 0;
+        uint64_t completed = 0;
+        uint64_t total_wait_us = 0;
+        uint64_t max_wait_us = 0;
+    };
+
     explicit ThreadPool(size_t threads,
-                        size_t max_waiting_tasks = std::numeric_limits<size_t>::max());
+                        size_t max_waiting_cost = std::numeric_limits<size_t>::max());
     template <class F, class... Args>
     auto enqueue(F &&f, Args &&...args) -> std::future<typename std::result_of<F(Args...)>::type>;
 
@@ -34,45 +59,86 @@ class ThreadPool
         std::future<T> future;
         bool will_wait;
         size_t waiting_tasks;
+        size_t waiting_cost;
     };
 
     template <class F, class... Args>
     auto enqueue_with_status(F &&f, Args &&...args)
         -> EnqueueResult<typename std::result_of<F(Args...)>::type>;
 
+    template <class F, class... Args>
+    auto enqueue_with_cost(size_t cost, size_t lane, F &&f, Args &&...args)
+        -> EnqueueResult<typename std::result_of<F(Args...)>::type>;
+
+    size_t size() const
+    {
+        return workers.size();
+    }
+
+    std::array<LaneStats, NumLanes> lane_stats();
+
     ~ThreadPool();
 
   private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Task
+    {
+        std::function<void()> func;
+        size_t cost;
+        Clock::time_point enqueued_at;
+    };
+
+    size_t next_lane();
+
     // need to keep track of threads so we can join them
     std::vector<std::thread> workers;
-    // the task queue
-    std::queue<std::function<void()>> tasks;
+    // the task queues, one per lane
+    std::array<std::queue<Task>, NumLanes> lanes;
+    std::array<size_t, NumLanes> bypassed;
+    std::array<LaneStats, NumLanes> stats;
 
     // synchronization
     std::mutex queue_mutex;
     std::condition_variable condition;
+    size_t waiting_tasks;
     size_t active_tasks;
-    size_t max_waiting_tasks;
+    size_t waiting_cost;
+    size_t max_waiting_cost;
     bool stop;
 };
 
 // the constructor just launches some amount of workers
-inline ThreadPool::ThreadPool(size_t threads, size_t max_waiting_tasks)
-    : active_tasks(0), max_waiting_tasks(max_waiting_tasks), stop(false)
+inline ThreadPool::ThreadPool(size_t threads, size_t max_waiting_cost)
+    : bypassed{}, stats{}, waiting_tasks(0), active_tasks(0), waiting_cost(0),
+      max_waiting_cost(max_waiting_cost), stop(false)
 {
     for (size_t i = 0; i < threads; ++i)
         workers.emplace_back([this] {
             for (;;) {
                 std::function<void()> task;
+                size_t lane;
 
                 {
                     std::unique_lock<std::mutex> lock(this->queue_mutex);
-                    this->condition.wait(lock,
-                                         [this] { return this->stop || !this->tasks.empty(); });
-                    if (this->stop && this->tasks.empty())
+                    this->condition.wait(
+                        lock, [this] { return this->stop || this->waiting_tasks > 0; });
+                    if (this->stop && this->waiting_tasks == 0)
                         return;
-                    task = std::move(this->tasks.front());
-                    this->tasks.pop();
+                    lane = this->next_lane();
+                    Task &front = this->lanes[lane].front();
+                    const uint64_t wait_us =
+                        std::chrono::duration_cast<std::chrono::microseconds>(
+                            Clock::now() - front.enqueued_at)
+                            .count();
+                    ++this->stats[lane].started;
+                    this->stats[lane].total_wait_us += wait_us;
+                    this->stats[lane].max_wait_us =
+                        std::max(this->stats[lane].max_wait_us, wait_us);
+                    task = std::move(front.func);
+                    this->waiting_cost -= front.cost;
+                    this->lanes[lane].pop();
+                    --this->waiting_tasks;
                     ++this->active_tasks;
                 }
 
@@ -81,12 +147,56 @@ inline ThreadPool::ThreadPool(size_t threads, size_t max_waiting_tasks)
                 {
                     std::unique_lock<std::mutex> lock(this->queue_mutex);
                     --this->active_tasks;
+                    ++this->stats[lane].completed;
                 }
                 this->condition.notify_all();
             }
         });
 }
 
+// choose the lane to take a task from (called with the queue mutex locked)
+inline size_t ThreadPool::next_lane()
+{
+    size_t lane = NumLanes;
+
+    // a lane that has been bypassed too many times goes first, lowest priority first
+    for (size_t i = NumLanes; i-- > 0;) {
+        if (!lanes[i].empty() && bypassed[i] >= MaxBypassed) {
+            lane = i;
+            break;
+        }
+    }
+
+    // otherwise the highest-priority lane with a waiting task
+    if (lane == NumLanes) {
+        for (size_t i = 0; i < NumLanes; ++i) {
+            if (!lanes[i].empty()) {
+                lane = i;
+                break;
+            }
+        }
+    }
+
+    for (size_t i = 0; i < NumLanes; ++i) {
+        if (i != lane && !lanes[i].empty())
+            ++bypassed[i];
+    }
+    bypassed[lane] = 0;
+
+    return lane;
+}
+
+// snapshot of the counters of each lane
+inline std::array<ThreadPool::LaneStats, ThreadPool::NumLanes> ThreadPool::lane_stats()
+{
+    std::unique_lock<std::mutex> lock(queue_mutex);
+    std::array<LaneStats, NumLanes> result = stats;
+    for (size_t i = 0; i < NumLanes; ++i)
+        result[i].waiting_tasks = lanes[i].size();
+
+    return result;
+}
+
 // add new work item to the pool
 template <class F, class... Args>
 auto ThreadPool::enqueue(F &&f, Args &&...args)
@@ -98,6 +208,13 @@ auto ThreadPool::enqueue(F &&f, Args &&...args)
 template <class F, class... Args>
 auto ThreadPool::enqueue_with_status(F &&f, Args &&...args)
     -> EnqueueResult<typename std::result_of<F(Args...)>::type>
+{
+    return enqueue_with_cost(1, 0, std::forward<F>(f), std::forward<Args>(args)...);
+}
+
+template <class F, class... Args>
+auto ThreadPool::enqueue_with_cost(size_t cost, size_t lane, F &&f, Args &&...args)
+    -> EnqueueResult<typename std::result_of<F(Args...)>::type>
 {
     using return_type = typename std::result_of<F(Args...)>::type;
 
@@ -105,8 +222,10 @@ auto ThreadPool::enqueue_with_status(F &&f, Args &&...args)
         std::bind(std::forward<F>(f), std::forward<Args>(args)...));
 
     std::future<return_type> res = task->get_future();
+    lane = std::min(lane, NumLanes - 1);
     bool will_wait = false;
-    size_t waiting_tasks = 0;
+    size_t total_tasks = 0;
+    size_t total_cost = 0;
     {
         std::unique_lock<std::mutex> lock(queue_mutex);
 
@@ -114,15 +233,21 @@ auto ThreadPool::enqueue_with_status(F &&f, Args &&...args)
         if (stop)
             throw std::runtime_error("enqueue on stopped ThreadPool");
 
-        if (tasks.size() >= max_waiting_tasks)
+        if (waiting_tasks > 0 && waiting_cost + cost > max_waiting_cost) {
+            ++stats[lane].rejected;
             throw ThreadPoolQueueFull();
+        }
 
-        will_wait = !tasks.empty() || active_tasks >= workers.size();
-        tasks.emplace([task]() { (*task)(); });
-        waiting_tasks = tasks.size();
+        will_wait = waiting_tasks > 0 || active_tasks >= workers.size();
+        lanes[lane].push({[task]() { (*task)(); }, cost, Clock::now()});
+        ++stats[lane].enqueued;
+        ++waiting_tasks;
+        waiting_cost += cost;
+        total_tasks = waiting_tasks;
+        total_cost = waiting_cost;
     }
     condition.notify_one();
-    return {std::move(res), will_wait, waiting_tasks};
+    return {std::move(res), will_wait, total_tasks, total_cost};
 }
 
 // the destructor joins all threads
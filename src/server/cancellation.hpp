@@ -0,0 +1,64 @@
+#ifndef MAHJONG_CPP_CANCELLATION
+#define MAHJONG_CPP_CANCELLATION
+
+#include <atomic>
+
+/**
+ * @brief The Cancellation class is shared by the requests waiting for one
+ *        calculation. The calculation is cancelled once every request has been
+ *        abandoned by its client, and it checks flag() periodically to stop.
+ */
+class Cancellation
+{
+  public:
+    /**
+     * @brief Create a cancellation with one waiting request.
+     */
+    Cancellation() : waiters_(1), cancelled_(false)
+    {
+    }
+
+    /**
+     * @brief Add a waiting request unless the calculation has been cancelled.
+     *
+     * @return true if the request was added
+     */
+    bool join()
+    {
+        int waiters = waiters_.load();
+        do {
+            if (waiters == 0) {
+                return false;
+            }
+        } while (!waiters_.compare_exchange_weak(waiters, waiters + 1));
+
+        return true;
+    }
+
+    /**
+     * @brief Remove a waiting request whose client has gone, and cancel the
+     *        calculation if no request is waiting for it.
+     */
+    void abandon()
+    {
+        if (waiters_.fetch_sub(1) == 1) {
+            cancelled_.store(true);
+        }
+    }
+
+    bool cancelled() const
+    {
+        return cancelled_.load();
+    }
+
+    const std::atomic<bool> &flag() const
+    {
+        return cancelled_;
+    }
+
+  private:
+    std::atomic<int> waiters_;
+    std::atomic<bool> cancelled_;
+};
+
+#endif // MAHJONG_CPP_CANCELLATION
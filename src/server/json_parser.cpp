@@ -470,6 +470,8 @@ void build_success_response(const Request &req, const CalculationResult &result,
     doc.AddMember("stats", serialize_expected_score(result.stats, doc), allocator);
     doc.AddMember("searched", result.searched, allocator);
     doc.AddMember("time", static_cast<int64_t>(result.time_us), allocator);
+    doc.AddMember("approximate", result.approximate, allocator);
+    doc.AddMember("cached", false, allocator);
 
     rapidjson::Value config_val(rapidjson::kObjectType);
     config_val.AddMember("enable_reddora", result.config.enable_reddora, allocator);
@@ -488,6 +490,22 @@ void build_success_response(const Request &req, const CalculationResult &result,
     doc.AddMember("config", config_val, allocator);
 }
 
+/**
+ * @brief Mark a success response JSON string as answered from the response cache.
+ *        The searched and time members are left as those of the calculation.
+ *
+ * @param[in] json Success response JSON string built by build_success_response().
+ * @return Response JSON string whose cached member is true.
+ */
+std::string mark_cached_response(const std::string &json)
+{
+    rapidjson::Document doc;
+    doc.Parse(json.c_str());
+    doc["cached"] = true;
+
+    return dump_json(doc);
+}
+
 /**
  * @brief Build an error response JSON document.
  *
@@ -27,6 +27,7 @@ struct CalculationResult
     std::vector<mahjong::ExpectedScoreCalculator::Stat> stats;
     int searched;
     long long time_us;
+    bool approximate = false;
 };
 
 std::string dump_json(const rapidjson::Document &doc);
@@ -34,6 +35,7 @@ void parse_json(const std::string &json, rapidjson::Document &doc);
 Request deserialize_request(const rapidjson::Document &doc);
 void build_success_response(const Request &req, const CalculationResult &result,
                             rapidjson::Document &doc);
+std::string mark_cached_response(const std::string &json);
 void build_error_response(const std::string &message, rapidjson::Document &doc);
 
 #endif // MAHJONG_CPP_JSON_PARSER_H
@@ -1,12 +1,25 @@
 #include "request_processor.hpp"
 
+#include <algorithm>
+#include <array>
 #include <chrono>
 #include <numeric>
 #include <stdexcept>
+#include <tuple>
 
 using namespace mahjong;
 
-CalculationResult calculate_result(const Request &req)
+// Maximum shanten number of hands whose statistics are calculated. Hands with more
+// shanten get only the shanten number and the necessary tiles.
+constexpr int MaxStatsShanten = 3;
+
+// Relative cost of a calculation by shanten number. The graph grows by about an order
+// of magnitude per shanten, and the search of hands with 3 shanten is bounded by the
+// time limit.
+constexpr std::array<size_t, MaxStatsShanten + 1> ShantenCost = {1, 5, 25, 100};
+
+CalculationResult calculate_result(const Request &req, const int search_budget_ms,
+                                   const std::atomic<bool> *cancel)
 {
     CalculationResult result;
 
@@ -19,31 +32,97 @@ CalculationResult calculate_result(const Request &req)
     result.config.sum = std::accumulate(req.wall.begin(), req.wall.begin() + 34, 0);
     result.config.extra = 1;
     result.config.shanten_type = ShantenFlag::All;
-    result.shanten = std::get<1>(
-        ShantenCalculator::calc(req.player.hand, req.player.num_melds(),
-                                ShantenFlag::All, req.table_config.game_mode));
-    result.regular_shanten = std::get<1>(
-        ShantenCalculator::calc(req.player.hand, req.player.num_melds(),
-                                ShantenFlag::StandardHand, req.table_config.game_mode));
-    result.seven_pairs_shanten = std::get<1>(
-        ShantenCalculator::calc(req.player.hand, req.player.num_melds(),
-                                ShantenFlag::SevenPairs, req.table_config.game_mode));
-    result.thirteen_orphans_shanten = std::get<1>(ShantenCalculator::calc(
-        req.player.hand, req.player.num_melds(), ShantenFlag::ThirteenOrphans,
-        req.table_config.game_mode));
-    result.config.calc_stats = result.shanten <= 3;
+    const HandAnalyzer::Result analysis =
+        HandAnalyzer::calc(req.player.hand, req.player.num_melds(), ShantenFlag::All,
+                           req.table_config.game_mode);
+    result.shanten = analysis.shanten;
+    result.regular_shanten = analysis.regular_shanten;
+    result.seven_pairs_shanten = analysis.seven_pairs_shanten;
+    result.thirteen_orphans_shanten = analysis.thirteen_orphans_shanten;
+    result.config.calc_stats = result.shanten <= MaxStatsShanten;
+    result.config.time_budget = search_budget_ms;
+    result.config.cancel = cancel;
 
     if (result.shanten == -1) {
         throw std::runtime_error(u8"手牌はすでに和了形です。");
     }
 
+    // Each worker thread reuses the buffers of the graph between requests.
+    thread_local ExpectedScoreCalculator::Context context;
+
     const auto start = std::chrono::steady_clock::now();
-    std::tie(result.stats, result.searched) =
-        ExpectedScoreCalculator::calc(result.config, req.table_config, req.round_state,
-                                      req.table_state, req.player, req.wall);
+    std::tie(result.stats, result.searched) = ExpectedScoreCalculator::calc(
+        result.config, req.table_config, req.round_state, req.table_state, req.player,
+        req.wall, context);
     const auto end = std::chrono::steady_clock::now();
+    if (context.is_cancelled()) {
+        throw std::runtime_error("Calculation cancelled because the client has gone");
+    }
+    result.approximate = context.is_approximate();
     result.time_us =
         std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
 
     return result;
 }
+
+size_t estimate_cost(const Request &req)
+{
+    const int num_tiles = std::accumulate(req.player.hand.begin(),
+                                          req.player.hand.begin() + 34, 0);
+    const int shanten = std::get<1>(
+        ShantenCalculator::calc(req.player.hand, req.player.num_melds(),
+                                ShantenFlag::All, req.table_config.game_mode));
+    // Hands without the statistics are as cheap as tenpai hands.
+    const size_t cost =
+        shanten > MaxStatsShanten ? ShantenCost[0] : ShantenCost[std::max(shanten, 0)];
+
+    // Hands with melds have fewer tiles to draw and discard.
+    return std::max<size_t>(1, cost * num_tiles / 14);
+}
+
+size_t priority_lane(const size_t cost)
+{
+    // Tenpai and 1-shanten hands, and the hands without statistics, are answered in
+    // milliseconds, so they go to the highest-priority lane, and 3-shanten hands to
+    // the lowest.
+    if (cost <= ShantenCost[1]) {
+        return 0;
+    }
+    if (cost <= ShantenCost[2]) {
+        return 1;
+    }
+
+    return 2;
+}
+
+std::vector<std::int64_t> canonical_key(const Request &req)
+{
+    // Everything that affects the response. The ip and version of the client are
+    // left out, as the response does not echo them.
+    std::vector<std::int64_t> key;
+    key.reserve(128);
+
+    key.insert(key.end(), {req.config.enable_reddora, req.config.enable_uradora,
+                           req.config.enable_shanten_down, req.config.enable_tegawari});
+    key.insert(key.end(), {req.table_config.rule_flags, req.table_config.game_mode});
+    key.insert(key.end(), {req.round_state.round_wind, req.round_state.round_number,
+                           req.round_state.honba, req.round_state.dealer});
+    key.push_back(req.table_state.kyotaku);
+    key.push_back(static_cast<std::int64_t>(req.table_state.dora_indicators.size()));
+    key.insert(key.end(), req.table_state.dora_indicators.begin(),
+               req.table_state.dora_indicators.end());
+    key.push_back(static_cast<std::int64_t>(req.table_state.uradora_indicators.size()));
+    key.insert(key.end(), req.table_state.uradora_indicators.begin(),
+               req.table_state.uradora_indicators.end());
+    key.insert(key.end(), req.player.hand.begin(), req.player.hand.end());
+    key.insert(key.end(), {req.player.seat_wind, req.player.nuki_count});
+    key.push_back(static_cast<std::int64_t>(req.player.melds.size()));
+    for (const auto &meld : req.player.melds) {
+        key.insert(key.end(), {meld.type, meld.discarded_tile, meld.from});
+        key.push_back(static_cast<std::int64_t>(meld.tiles.size()));
+        key.insert(key.end(), meld.tiles.begin(), meld.tiles.end());
+    }
+    key.insert(key.end(), req.wall.begin(), req.wall.end());
+
+    return key;
+}
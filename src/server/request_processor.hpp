@@ -1,8 +1,22 @@
 #ifndef MAHJONG_CPP_REQUEST_PROCESSOR
 #define MAHJONG_CPP_REQUEST_PROCESSOR
 
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
 #include "json_parser.hpp"
 
-CalculationResult calculate_result(const Request &req);
+// Time budget of the search, after which only the shortest paths are searched. It is
+// not a hard timeout, as the search of the shortest paths is not limited.
+constexpr int DefaultSearchBudgetMs = 3000;
+
+// The calculation throws std::runtime_error if it is stopped by cancel.
+CalculationResult calculate_result(const Request &req,
+                                   int search_budget_ms = DefaultSearchBudgetMs,
+                                   const std::atomic<bool> *cancel = nullptr);
+size_t estimate_cost(const Request &req);
+size_t priority_lane(size_t cost);
+std::vector<std::int64_t> canonical_key(const Request &req);
 
 #endif // MAHJONG_CPP_REQUEST_PROCESSOR
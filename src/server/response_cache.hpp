@@ -0,0 +1,212 @@
+#ifndef MAHJONG_CPP_RESPONSE_CACHE
+#define MAHJONG_CPP_RESPONSE_CACHE
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <boost/container_hash/hash.hpp>
+
+#include "cancellation.hpp"
+
+/**
+ * @brief The ResponseCache class keeps the responses of the latest requests for a
+ *        limited time. The least recently used response is evicted first.
+ *        Identical requests that arrive while one of them is being calculated wait
+ *        for its response instead of being calculated again, and the calculation
+ *        is cancelled once all of them have been abandoned.
+ */
+template <class Value> class ResponseCache
+{
+  public:
+    using Key = std::vector<std::int64_t>;
+    using Callback = std::function<void(const Value &)>;
+
+    enum class Status
+    {
+        /* The cached response was found. */
+        Hit,
+        /* An identical request is being calculated, and the callback is called
+           with its response. */
+        Joined,
+        /* The caller calculates the response and passes it to complete(). */
+        Miss,
+    };
+
+    struct Stats
+    {
+        /* number of requests answered from the cache */
+        std::size_t hits = 0;
+        /* number of requests that waited for an identical request */
+        std::size_t joined = 0;
+        /* number of requests calculated */
+        std::size_t misses = 0;
+        /* number of cached responses */
+        std::size_t size = 0;
+        /* maximum number of cached responses */
+        std::size_t capacity = 0;
+    };
+
+    /**
+     * @brief Create a cache. The cache is disabled if the capacity is 0.
+     *
+     * @param[in] capacity maximum number of cached responses
+     * @param[in] ttl time for which a response is kept
+     */
+    ResponseCache(const std::size_t capacity, const std::chrono::milliseconds ttl)
+        : capacity_(capacity), ttl_(ttl)
+    {
+    }
+
+    /**
+     * @brief Find the response of a request.
+     *
+     * @param[in] key key of the request
+     * @param[out] value cached response if the status is Hit
+     * @param[in] callback function called with the response if the status is Joined
+     * @param[out] cancellation cancellation of the calculation if the status is
+     *             Joined or Miss, which the request abandons if its client has gone
+     * @return status of the lookup
+     */
+    Status find(const Key &key, Value &value, Callback callback,
+                std::shared_ptr<Cancellation> &cancellation)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (capacity_ == 0) {
+            cancellation = std::make_shared<Cancellation>();
+            ++misses_;
+            return Status::Miss;
+        }
+
+        if (const auto itr = index_.find(key); itr != index_.end()) {
+            if (Clock::now() < itr->second->expires_at) {
+                entries_.splice(entries_.begin(), entries_, itr->second);
+                value = itr->second->value;
+                ++hits_;
+                return Status::Hit;
+            }
+
+            entries_.erase(itr->second);
+            index_.erase(itr);
+        }
+
+        // A calculation abandoned by all of its requests is being cancelled, so
+        // it is replaced by a new one.
+        if (const auto itr = in_flight_.find(key);
+            itr != in_flight_.end() && itr->second.cancellation->join()) {
+            itr->second.callbacks.push_back(std::move(callback));
+            cancellation = itr->second.cancellation;
+            ++joined_;
+            return Status::Joined;
+        }
+
+        cancellation = std::make_shared<Cancellation>();
+        in_flight_[key] = {cancellation, {}};
+        ++misses_;
+        return Status::Miss;
+    }
+
+    /**
+     * @brief Pass the response of a request that missed the cache to the requests
+     *        waiting for it, and keep the cached response if it is given.
+     *
+     * @param[in] key key of the request
+     * @param[in] cancellation cancellation returned by find()
+     * @param[in] value response
+     * @param[in] cached response returned by find() on a hit, which may differ from
+     *            the response of the calculation, or std::nullopt to keep nothing
+     */
+    void complete(const Key &key, const std::shared_ptr<Cancellation> &cancellation,
+                  const Value &value, const std::optional<Value> &cached)
+    {
+        std::vector<Callback> waiters;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (const auto itr = in_flight_.find(key);
+                itr != in_flight_.end() && itr->second.cancellation == cancellation) {
+                waiters = std::move(itr->second.callbacks);
+                in_flight_.erase(itr);
+            }
+
+            if (cached && capacity_ > 0) {
+                insert(key, *cached);
+            }
+        }
+
+        // The callbacks are called without the lock, as they may use the cache.
+        for (const auto &callback : waiters) {
+            callback(value);
+        }
+    }
+
+    Stats stats()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return {hits_, joined_, misses_, index_.size(), capacity_};
+    }
+
+  private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Entry
+    {
+        Key key;
+        Value value;
+        Clock::time_point expires_at;
+    };
+
+    struct Flight
+    {
+        std::shared_ptr<Cancellation> cancellation;
+        std::vector<Callback> callbacks;
+    };
+
+    struct KeyHash
+    {
+        std::size_t operator()(const Key &key) const noexcept
+        {
+            return boost::hash_range(key.begin(), key.end());
+        }
+    };
+
+    using List = std::list<Entry>;
+
+    void insert(const Key &key, const Value &value)
+    {
+        const Clock::time_point expires_at = Clock::now() + ttl_;
+        if (const auto itr = index_.find(key); itr != index_.end()) {
+            itr->second->value = value;
+            itr->second->expires_at = expires_at;
+            entries_.splice(entries_.begin(), entries_, itr->second);
+            return;
+        }
+
+        entries_.push_front({key, value, expires_at});
+        index_.emplace(key, entries_.begin());
+        while (index_.size() > capacity_) {
+            index_.erase(entries_.back().key);
+            entries_.pop_back();
+        }
+    }
+
+    std::mutex mutex_;
+    const std::size_t capacity_;
+    const std::chrono::milliseconds ttl_;
+    std::size_t hits_ = 0;
+    std::size_t joined_ = 0;
+    std::size_t misses_ = 0;
+    /* most recently used first */
+    List entries_;
+    std::unordered_map<Key, typename List::iterator, KeyHash> index_;
+    /* requests being calculated and the callbacks waiting for them */
+    std::unordered_map<Key, Flight, KeyHash> in_flight_;
+};
+
+#endif // MAHJONG_CPP_RESPONSE_CACHE
@@ -1,10 +1,21 @@
 #include "server.hpp"
-#include "request_processor.hpp"
 
+#include <algorithm>
+#include <chrono>
 #include <fstream>
+#include <future>
 #include <iostream>
-
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include <boost/asio/dispatch.hpp>
 #include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/post.hpp>
+#include <boost/asio/strand.hpp>
 #include <boost/beast/core.hpp>
 #include <boost/beast/http.hpp>
 #include <boost/beast/version.hpp>
@@ -40,18 +51,66 @@ std::string build_error_json(const std::string &message)
     return dump_json(doc);
 }
 
-Server &get_server()
+} // namespace
+
+// Sessions only wait for sockets, so a few I/O threads serve all connections.
+constexpr int DefaultNumIoThreads = 2;
+
+// Cost of the waiting requests allowed per worker, which is about one 3-shanten
+// request or a hundred tenpai requests (see estimate_cost()).
+constexpr size_t QueueCostPerWorker = 100;
+
+// Idle time after which a keep-alive connection is closed.
+constexpr auto SessionTimeout = std::chrono::seconds(60);
+
+// Size of the pipelined requests buffered while a request is being calculated.
+constexpr size_t MaxPipelinedSize = 1 << 20;
+
+Server::Server() : Server(Options())
 {
-    static Server server;
-    return server;
 }
 
-} // namespace
+Server::Server(const Options &options)
+    : options_(resolve_options(options)),
+      response_cache_(options_.cache_capacity,
+                      std::chrono::milliseconds(options_.cache_ttl_ms)),
+      pool_(options_.num_workers, options_.max_queue_cost)
+{
+}
 
-constexpr size_t MaxWaitingRequests = 20;
+Server::Options Server::resolve_options(Options options)
+{
+    // hardware_concurrency() may return 0 if the value is not computable.
+    const int num_threads = static_cast<int>(std::thread::hardware_concurrency());
+
+    if (options.num_io_threads <= 0) {
+        options.num_io_threads = DefaultNumIoThreads;
+    }
+    if (options.num_workers <= 0) {
+        // Leave a hardware thread for the I/O threads, which are mostly idle.
+        options.num_workers = std::max(1, num_threads - 1);
+    }
+    if (options.max_queue_cost == 0) {
+        options.max_queue_cost = options.num_workers * QueueCostPerWorker;
+    }
+    if (options.search_budget_ms <= 0) {
+        options.search_budget_ms = DefaultSearchBudgetMs;
+    }
+
+    return options;
+}
 
-Server::Server() : pool_(3, MaxWaitingRequests)
+void Server::log_lane_stats()
 {
+    const auto stats = pool_.lane_stats();
+    for (size_t lane = 0; lane < stats.size(); ++lane) {
+        const ThreadPool::LaneStats &s = stats[lane];
+        get_logger()->info("Calculation lane {}: waiting={}, enqueued={}, rejected={}, "
+                           "completed={}, avg_wait_ms={}, max_wait_ms={}",
+                           lane, s.waiting_tasks, s.enqueued, s.rejected, s.completed,
+                           s.started > 0 ? s.total_wait_us / s.started / 1000 : 0,
+                           s.max_wait_us / 1000);
+    }
 }
 
 void Server::log_request(const Request &req)
@@ -93,31 +152,67 @@ void Server::log_request(const Request &req)
 }
 
 std::string Server::process_request(const std::string &json)
+{
+    Request req;
+    std::string response;
+    if (!parse_request(json, req, response)) {
+        return response;
+    }
+
+    bool cacheable;
+    return calculate_response(req, nullptr, cacheable);
+}
+
+// Parses and validates the request, and returns false with the error response if the
+// request is invalid.
+bool Server::parse_request(const std::string &json, Request &req, std::string &response)
 {
     rapidjson::Document req_doc;
-    rapidjson::Document res_doc;
-    res_doc.SetObject();
 
     try {
         parse_json(json, req_doc);
     }
     catch (const std::exception &e) {
-        build_error_response(e.what(), res_doc);
         get_logger()->info("Failed to process request: reason={}.", e.what());
-        return dump_json(res_doc);
+        response = build_error_json(e.what());
+        return false;
+    }
+
+    try {
+        req = deserialize_request(req_doc);
+    }
+    catch (const std::exception &e) {
+        const std::string ip =
+            req_doc.HasMember("ip") ? req_doc["ip"].GetString() : "";
+        get_logger()->info("Failed to process request: ip={}, reason={}.", ip,
+                           e.what());
+        response = build_error_json(e.what());
+        return false;
     }
 
-    const std::string ip = req_doc.HasMember("ip") ? req_doc["ip"].GetString() : "";
+    log_request(req);
+
+    return true;
+}
+
+// Calculates the response, which is cacheable if the search was not cut short by the
+// time limit.
+std::string Server::calculate_response(const Request &req,
+                                       const std::atomic<bool> *cancel, bool &cacheable)
+{
+    rapidjson::Document res_doc;
+    res_doc.SetObject();
+    cacheable = false;
 
     try {
-        Request req = deserialize_request(req_doc);
-        log_request(req);
-        CalculationResult result = calculate_result(req);
+        CalculationResult result =
+            calculate_result(req, options_.search_budget_ms, cancel);
         build_success_response(req, result, res_doc);
+        cacheable = !result.approximate;
     }
     catch (const std::exception &e) {
         build_error_response(e.what(), res_doc);
-        get_logger()->info("Failed to process request: ip={}, reason={}.", ip,
+        get_logger()->info("Failed to process request: ip={}, reason={}.", req.ip,
                            e.what());
         return dump_json(res_doc);
     }
@@ -127,93 +222,85 @@ std::string Server::process_request(const std::string &json)
 
 Server::HttpResponse Server::process_http_post(const std::string &json)
 {
+    std::promise<HttpResponse> promise;
+    std::future<HttpResponse> future = promise.get_future();
+    async_process_http_post(json, [&promise](HttpResponse response) {
+        promise.set_value(std::move(response));
+    });
+
+    return future.get();
+}
+
+std::shared_ptr<Cancellation> Server::async_process_http_post(const std::string &json,
+                                                              ResponseHandler handler)
+{
+    // The request is parsed on the calling thread to estimate the cost of the
+    // calculation before it is queued. Invalid requests never reach the queue.
+    Request req;
+    std::string response;
+    if (!parse_request(json, req, response)) {
+        handler({static_cast<unsigned>(http::status::ok), "application/json",
+                 std::move(response)});
+        return nullptr;
+    }
+
+    // A cached response skips the queue, and identical requests share a calculation.
+    // The ip and version are not part of the key, and the response does not echo
+    // them, so the same response is returned to every client. A cached response
+    // keeps the searched and time of its calculation, and its cached member is true.
+    // It is marked once when it is stored, so a hit only copies it.
+    const ResponseCache<HttpResponse>::Key key = canonical_key(req);
+    HttpResponse cached;
+    std::shared_ptr<Cancellation> cancellation;
+    switch (response_cache_.find(key, cached, handler, cancellation)) {
+    case ResponseCache<HttpResponse>::Status::Hit:
+        handler(std::move(cached));
+        return nullptr;
+    case ResponseCache<HttpResponse>::Status::Joined:
+        return cancellation;
+    case ResponseCache<HttpResponse>::Status::Miss:
+        break;
+    }
+
+    const size_t cost = estimate_cost(req);
+    const size_t lane = priority_lane(cost);
+
     try {
-        ThreadPool::EnqueueResult<std::string> queued =
-            pool_.enqueue_with_status([this, json] { return process_request(json); });
+        ThreadPool::EnqueueResult<void> queued = pool_.enqueue_with_cost(
+            cost, lane, [this, key, cancellation, req = std::move(req), handler] {
+                bool cacheable;
+                HttpResponse response{
+                    static_cast<unsigned>(http::status::ok), "application/json",
+                    calculate_response(req, &cancellation->flag(), cacheable)};
+                std::optional<HttpResponse> stored;
+                if (cacheable) {
+                    stored = response;
+                    stored->body = mark_cached_response(response.body);
+                }
+                response_cache_.complete(key, cancellation, response, stored);
+                handler(std::move(response));
+            });
 
         if (queued.will_wait) {
             get_logger()->warn(
                 "Request queued because all calculation workers are busy: "
-                "waiting={}, body_size={}",
-                queued.waiting_tasks, json.size());
+                "waiting={}, waiting_cost={}, cost={}, lane={}",
+                queued.waiting_tasks, queued.waiting_cost, cost, lane);
         }
-
-        return {static_cast<unsigned>(http::status::ok), "application/json",
-                queued.future.get()};
     }
     catch (const ThreadPoolQueueFull &) {
         get_logger()->warn("Request rejected because the calculation queue is full: "
-                           "max_waiting={}, body_size={}",
-                           MaxWaitingRequests, json.size());
-        return {static_cast<unsigned>(http::status::service_unavailable),
-                "application/json", build_error_json("Server busy.")};
+                           "max_queue_cost={}, cost={}, lane={}, body_size={}",
+                           options_.max_queue_cost, cost, lane, json.size());
+        log_lane_stats();
+        HttpResponse response{static_cast<unsigned>(http::status::service_unavailable),
+                              "application/json", build_error_json("Server busy.")};
+        response_cache_.complete(key, cancellation, response, std::nullopt);
+        handler(std::move(response));
+        return nullptr;
     }
-}
-
-// This function produces an HTTP response for the given
-// request. The type of the response object depends on the
-// contents of the request, so the interface requires the
-// caller to pass a generic lambda for receiving the response.
-template <class Body, class Allocator, class Send>
-void handle_request(beast::string_view doc_root,
-                    http::request<Body, http::basic_fields<Allocator>> &&req,
-                    Send &&send)
-{
-    // Returns a bad request response
-    auto const bad_request = [&req](beast::string_view why) {
-        http::response<http::string_body> res{http::status::bad_request, req.version()};
-        res.set(http::field::server, BOOST_BEAST_VERSION_STRING);
-        res.set(http::field::content_type, "text/html");
-        res.keep_alive(req.keep_alive());
-        res.body() = std::string(why);
-        res.prepare_payload();
-        return res;
-    };
-
-    // Returns a not found response
-    auto const not_found = [&req](beast::string_view target) {
-        http::response<http::string_body> res{http::status::not_found, req.version()};
-        res.set(http::field::server, BOOST_BEAST_VERSION_STRING);
-        res.set(http::field::content_type, "text/html");
-        res.keep_alive(req.keep_alive());
-        res.body() = "The resource '" + std::string(target) + "' was not found.";
-        res.prepare_payload();
-        return res;
-    };
-
-    // Returns a server error response
-    auto const server_error = [&req](beast::string_view what) {
-        http::response<http::string_body> res{http::status::internal_server_error,
-                                              req.version()};
-        res.set(http::field::server, BOOST_BEAST_VERSION_STRING);
-        res.set(http::field::content_type, "text/html");
-        res.keep_alive(req.keep_alive());
-        res.body() = "An error occurred: '" + std::string(what) + "'";
-        res.prepare_payload();
-        return res;
-    };
 
-    // Make sure we can handle the method
-    if (req.method() != http::verb::post)
-        return send(bad_request("Unknown HTTP-method"));
-
-    // Request path must be absolute and not contain "..".
-    if (req.target().empty() || req.target()[0] != '/' ||
-        req.target().find("..") != beast::string_view::npos)
-        return send(bad_request("Illegal request-target"));
-
-    const Server::HttpResponse response = get_server().process_http_post(req.body());
-
-    // Respond to GET request
-    http::response<http::string_body> res{
-        std::piecewise_construct, std::make_tuple(response.body),
-        std::make_tuple(static_cast<http::status>(response.status), req.version())};
-    res.set(http::field::server, BOOST_BEAST_VERSION_STRING);
-    res.set(http::field::content_type, response.content_type);
-    res.set(http::field::access_control_allow_origin, "*");
-    res.prepare_payload();
-    res.keep_alive(req.keep_alive());
-    return send(std::move(res));
+    return cancellation;
 }
 
 // Report a failure
@@ -222,93 +309,263 @@ void fail(beast::error_code ec, char const *what)
     std::cerr << what << ": " << ec.message() << "\n";
 }
 
-// This is the C++11 equivalent of a generic lambda.
-// The function object is used to send an HTTP message.
-template <class Stream> struct send_lambda
+// Handles an HTTP server connection.
+// All handlers of a session run on the strand of its socket, and calculations run
+// on the thread pool, so no thread is blocked while a request is being calculated.
+class Session : public std::enable_shared_from_this<Session>
 {
-    Stream &stream_;
-    bool &close_;
-    beast::error_code &ec_;
+  public:
+    Session(Server &server, tcp::socket &&socket)
+        : server_(server), stream_(std::move(socket))
+    {
+    }
+
+    void run()
+    {
+        net::dispatch(stream_.get_executor(),
+                      beast::bind_front_handler(&Session::do_read, shared_from_this()));
+    }
 
-    explicit send_lambda(Stream &stream, bool &close, beast::error_code &ec)
-        : stream_(stream), close_(close), ec_(ec)
+  private:
+    void do_read()
     {
+        // Make the request empty before reading, otherwise the operation behavior is
+        // undefined.
+        req_ = {};
+
+        stream_.expires_after(SessionTimeout);
+        http::async_read(
+            stream_, buffer_, req_,
+            beast::bind_front_handler(&Session::on_read, shared_from_this()));
     }
 
-    template <bool isRequest, class Body, class Fields>
-    void operator()(http::message<isRequest, Body, Fields> &&msg) const
+    void on_read(beast::error_code ec, std::size_t)
     {
-        // Determine if we should close the connection after
-        close_ = msg.need_eof();
+        // This means they closed the connection
+        if (ec == http::error::end_of_stream || ec == beast::error::timeout)
+            return do_close();
+        if (ec)
+            return fail(ec, "read");
 
-        // We need the serializer here because the serializer requires
-        // a non-const file_body, and the message oriented version of
-        // http::write only works with const messages.
-        http::serializer<isRequest, Body, Fields> sr{msg};
-        http::write(stream_, sr, ec_);
+        // The timeout is for idle connections, and must not expire while the request
+        // is being calculated.
+        stream_.expires_never();
+
+        handle_request();
     }
-};
 
-// Handles an HTTP server connection
-void do_session(tcp::socket &socket, std::shared_ptr<std::string const> const &doc_root)
-{
-    bool close = false;
-    beast::error_code ec;
+    // This function produces an HTTP response for the request.
+    void handle_request()
+    {
+        // Returns a bad request response
+        auto const bad_request = [this](beast::string_view why) {
+            http::response<http::string_body> res{http::status::bad_request,
+                                                  req_.version()};
+            res.set(http::field::server, BOOST_BEAST_VERSION_STRING);
+            res.set(http::field::content_type, "text/html");
+            res.keep_alive(req_.keep_alive());
+            res.body() = std::string(why);
+            res.prepare_payload();
+            return res;
+        };
+
+        // Make sure we can handle the method
+        if (req_.method() != http::verb::post)
+            return send(bad_request("Unknown HTTP-method"));
+
+        // Request path must be absolute and not contain "..".
+        if (req_.target().empty() || req_.target()[0] != '/' ||
+            req_.target().find("..") != beast::string_view::npos)
+            return send(bad_request("Illegal request-target"));
+
+        // The response is sent from the strand once the calculation is done.
+        pending_ = server_.async_process_http_post(
+            req_.body(), [self = shared_from_this()](Server::HttpResponse response) {
+                net::post(self->stream_.get_executor(),
+                          [self, response = std::move(response)]() mutable {
+                              self->on_response(std::move(response));
+                          });
+            });
+
+        if (pending_)
+            watch_disconnect();
+    }
 
-    // This buffer is required to persist across reads
-    beast::flat_buffer buffer;
+    // Waits for the client to close the connection while the request is calculated,
+    // so that the calculation can be cancelled.
+    void watch_disconnect()
+    {
+        stream_.socket().async_wait(
+            tcp::socket::wait_read,
+            beast::bind_front_handler(&Session::on_readable, shared_from_this()));
+    }
 
-    // This lambda is used to send messages
-    send_lambda<tcp::socket> lambda{socket, close, ec};
+    void on_readable(beast::error_code ec)
+    {
+        if (!pending_ || ec == net::error::operation_aborted)
+            return;
+
+        // A pipelined request is readable as well, so only the end of the stream or
+        // an error means that the client has gone. The request is moved into the
+        // buffer of the next read, and the connection is watched again.
+        if (!ec) {
+            const size_t available = stream_.socket().available(ec);
+            // Stop watching rather than buffer requests without limit.
+            if (!ec && buffer_.size() + available > MaxPipelinedSize)
+                return;
+            if (!ec) {
+                const size_t size = stream_.socket().read_some(
+                    buffer_.prepare(std::max<size_t>(available, 1)), ec);
+                buffer_.commit(size);
+                if (!ec)
+                    return watch_disconnect();
+            }
+        }
 
-    for (;;) {
-        // Read a request
-        http::request<http::string_body> req;
-        http::read(socket, buffer, req, ec);
-        if (ec == http::error::end_of_stream)
-            break;
-        if (ec)
-            return fail(ec, "read");
+        pending_->abandon();
+        pending_.reset();
+        abandoned_ = true;
+        do_close();
+    }
+
+    void on_response(Server::HttpResponse &&response)
+    {
+        // The client has gone, and nobody reads the response.
+        if (abandoned_)
+            return;
+
+        // Stop waiting for the client to close the connection.
+        pending_.reset();
+        beast::error_code ec;
+        stream_.socket().cancel(ec);
+
+        http::response<http::string_body> res{
+            std::piecewise_construct, std::make_tuple(std::move(response.body)),
+            std::make_tuple(static_cast<http::status>(response.status),
+                            req_.version())};
+        res.set(http::field::server, BOOST_BEAST_VERSION_STRING);
+        res.set(http::field::content_type, response.content_type);
+        res.set(http::field::access_control_allow_origin, "*");
+        res.prepare_payload();
+        res.keep_alive(req_.keep_alive());
+        send(std::move(res));
+    }
 
-        // Send the response
-        handle_request(*doc_root, std::move(req), lambda);
+    void send(http::response<http::string_body> &&res)
+    {
+        // The response must persist until the write completes.
+        res_ = std::move(res);
+        stream_.expires_after(SessionTimeout);
+        http::async_write(stream_, res_,
+                          beast::bind_front_handler(&Session::on_write,
+                                                    shared_from_this(),
+                                                    res_.need_eof()));
+    }
+
+    void on_write(bool close, beast::error_code ec, std::size_t)
+    {
         if (ec)
             return fail(ec, "write");
+
         if (close) {
             // This means we should close the connection, usually because
             // the response indicated the "Connection: close" semantic.
-            break;
+            return do_close();
         }
+
+        // Read another request
+        do_read();
     }
 
-    // Send a TCP shutdown
-    socket.shutdown(tcp::socket::shutdown_send, ec);
+    void do_close()
+    {
+        // Send a TCP shutdown
+        beast::error_code ec;
+        stream_.socket().shutdown(tcp::socket::shutdown_send, ec);
 
-    // At this point the connection is closed gracefully
-}
+        // At this point the connection is closed gracefully
+    }
+
+    Server &server_;
+    beast::tcp_stream stream_;
+    beast::flat_buffer buffer_;
+    http::request<http::string_body> req_;
+    http::response<http::string_body> res_;
+    std::shared_ptr<Cancellation> pending_;
+    bool abandoned_ = false;
+};
+
+// Accepts incoming connections and launches the sessions
+class Listener : public std::enable_shared_from_this<Listener>
+{
+  public:
+    Listener(Server &server, net::io_context &ioc, const tcp::endpoint &endpoint)
+        : server_(server), ioc_(ioc), acceptor_(net::make_strand(ioc), endpoint)
+    {
+    }
+
+    void run()
+    {
+        do_accept();
+    }
+
+  private:
+    void do_accept()
+    {
+        // The new connection gets its own strand
+        acceptor_.async_accept(
+            net::make_strand(ioc_),
+            beast::bind_front_handler(&Listener::on_accept, shared_from_this()));
+    }
+
+    void on_accept(beast::error_code ec, tcp::socket socket)
+    {
+        if (ec) {
+            fail(ec, "accept");
+        }
+        else {
+            std::make_shared<Session>(server_, std::move(socket))->run();
+        }
 
-int Server::run(unsigned short port)
+        // Accept another connection
+        do_accept();
+    }
+
+    Server &server_;
+    net::io_context &ioc_;
+    tcp::acceptor acceptor_;
+};
+
+int Server::run()
 {
-    get_logger()->info("Starting server on port {}", port);
+    const int num_io_threads = options_.num_io_threads;
+    get_logger()->info("Starting server on port {}: workers={}, io_threads={}, "
+                       "max_queue_cost={}, search_budget_ms={}, cache_capacity={}, "
+                       "cache_ttl_ms={}",
+                       options_.port, options_.num_workers, num_io_threads,
+                       options_.max_queue_cost, options_.search_budget_ms,
+                       options_.cache_capacity, options_.cache_ttl_ms);
 
     try {
         auto const address = net::ip::make_address("0.0.0.0");
-        auto const doc_root = std::make_shared<std::string>(".");
 
         // The io_context is required for all I/O
-        net::io_context ioc{1};
+        net::io_context ioc{num_io_threads};
 
-        // The acceptor receives incoming connections
-        tcp::acceptor acceptor{ioc, {address, port}};
-        for (;;) {
-            // This will receive the new connection
-            tcp::socket socket{ioc};
+        // The listener receives incoming connections
+        std::make_shared<Listener>(*this, ioc, tcp::endpoint{address, options_.port})
+            ->run();
 
-            // Block until we get a connection
-            acceptor.accept(socket);
+        // Run the I/O service on the requested number of threads
+        std::vector<std::thread> threads;
+        threads.reserve(num_io_threads - 1);
+        for (int i = 0; i < num_io_threads - 1; ++i) {
+            threads.emplace_back([&ioc] { ioc.run(); });
+        }
+        ioc.run();
 
-            // Launch the session, transferring ownership of the socket
-            std::thread{std::bind(&do_session, std::move(socket), doc_root)}.detach();
+        for (auto &thread : threads) {
+            thread.join();
         }
     }
     catch (const std::exception &e) {
@@ -320,11 +577,119 @@ int Server::run(unsigned short port)
 }
 
 #ifndef MAHJONG_CPP_DISABLE_SERVER_MAIN
+namespace
+{
+
+// Reads the options from a JSON file, e.g. {"port": 50000, "workers": 8}.
+void load_config_file(const std::string &path, Server::Options &options)
+{
+    std::ifstream ifs(path);
+    if (!ifs) {
+        throw std::runtime_error("Failed to open config file: " + path);
+    }
+
+    rapidjson::IStreamWrapper isw(ifs);
+    rapidjson::Document doc;
+    if (doc.ParseStream(isw).HasParseError() || !doc.IsObject()) {
+        throw std::runtime_error("Failed to parse config file: " + path);
+    }
+
+    auto read_int = [&](const char *name, auto &value) {
+        if (!doc.HasMember(name)) {
+            return;
+        }
+        if (!doc[name].IsUint()) {
+            throw std::runtime_error(std::string("Invalid value for ") + name);
+        }
+        value = static_cast<std::decay_t<decltype(value)>>(doc[name].GetUint());
+    };
+
+    read_int("port", options.port);
+    read_int("workers", options.num_workers);
+    read_int("io_threads", options.num_io_threads);
+    read_int("max_queue_cost", options.max_queue_cost);
+    read_int("search_budget_ms", options.search_budget_ms);
+    read_int("cache_capacity", options.cache_capacity);
+    read_int("cache_ttl_ms", options.cache_ttl_ms);
+}
+
+// Usage: nanikiru [port] [--config <file>] [--workers <n>] [--io-threads <n>]
+//                 [--max-queue-cost <n>] [--search-budget-ms <n>]
+//                 [--cache-capacity <n>] [--cache-ttl-ms <n>]
+// Options on the command line take precedence over the config file. The search budget
+// is not a hard timeout: once it runs out, only the shortest paths are searched.
+Server::Options parse_options(const int argc, char **argv)
+{
+    Server::Options options;
+
+    // The config file is read first so that the other options override it.
+    for (int i = 1; i + 1 < argc; ++i) {
+        if (std::string(argv[i]) == "--config") {
+            load_config_file(argv[i + 1], options);
+        }
+    }
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        auto read_value = [&](const char *name) -> int {
+            if (i + 1 >= argc) {
+                throw std::runtime_error(std::string("Missing value for ") + name);
+            }
+            const std::string value = argv[++i];
+            try {
+                return std::stoi(value);
+            }
+            catch (const std::exception &) {
+                throw std::runtime_error(std::string("Invalid value for ") + name +
+                                         ": " + value);
+            }
+        };
+
+        if (arg == "--config") {
+            ++i;
+        }
+        else if (arg == "--workers") {
+            options.num_workers = read_value("--workers");
+        }
+        else if (arg == "--io-threads") {
+            options.num_io_threads = read_value("--io-threads");
+        }
+        else if (arg == "--max-queue-cost") {
+            options.max_queue_cost =
+                static_cast<size_t>(std::max(0, read_value("--max-queue-cost")));
+        }
+        else if (arg == "--search-budget-ms") {
+            options.search_budget_ms = read_value("--search-budget-ms");
+        }
+        else if (arg == "--cache-capacity") {
+            options.cache_capacity =
+                static_cast<size_t>(std::max(0, read_value("--cache-capacity")));
+        }
+        else if (arg == "--cache-ttl-ms") {
+            options.cache_ttl_ms = read_value("--cache-ttl-ms");
+        }
+        else if (i == 1 && arg.rfind("--", 0) != 0) {
+            options.port = static_cast<unsigned short>(std::atoi(arg.c_str()));
+        }
+        else {
+            throw std::runtime_error("Unknown option: " + arg);
+        }
+    }
+
+    return options;
+}
+
+} // namespace
+
 int main(int argc, char *argv[])
 {
-    unsigned short port = 50000;
-    if (argc == 2) {
-        port = static_cast<unsigned short>(std::atoi(argv[1]));
+    Server::Options options;
+    try {
+        options = parse_options(argc, argv);
+    }
+    catch (const std::exception &e) {
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
     }
 
     auto console_sink = std::make_shared<spdlog::sinks::stdout_color_sink_mt>();
@@ -338,6 +703,7 @@ int main(int argc, char *argv[])
 
     get_logger()->info("Starting {} version {}", PROJECT_NAME, PROJECT_VERSION);
 
-    return get_server().run(port);
+    Server server(options);
+    return server.run();
 }
 #endif
@@ -1,8 +1,15 @@
 #ifndef MAHJONG_CPP_SERVER
 #define MAHJONG_CPP_SERVER
 
+#include <functional>
+#include <memory>
+#include <string>
+
 #include "ThreadPool.hpp"
+#include "cancellation.hpp"
 #include "json_parser.hpp"
+#include "request_processor.hpp"
+#include "response_cache.hpp"
 #include "mahjong/mahjong.hpp"
 
 class Server
@@ -15,14 +22,50 @@ class Server
         std::string body;
     };
 
+    // Called with the response on a calculation worker thread, or on the calling
+    // thread if the request is rejected. async_process_http_post() returns the
+    // cancellation to abandon if the client goes away before the handler is called,
+    // or nullptr if the handler has already been called.
+    using ResponseHandler = std::function<void(HttpResponse)>;
+
+    // Zero workers, I/O threads or queue cost means a default derived from the number
+    // of hardware threads. Zero cache capacity disables the response cache.
+    struct Options
+    {
+        unsigned short port = 50000;
+        int num_workers = 0;
+        int num_io_threads = 0;
+        size_t max_queue_cost = 0;
+        int search_budget_ms = DefaultSearchBudgetMs;
+        size_t cache_capacity = 1024;
+        int cache_ttl_ms = 60000;
+    };
+
     Server();
-    int run(unsigned short port);
+    explicit Server(const Options &options);
+    int run();
     std::string process_request(const std::string &json);
     HttpResponse process_http_post(const std::string &json);
-    ThreadPool pool_;
+    std::shared_ptr<Cancellation> async_process_http_post(const std::string &json,
+                                                          ResponseHandler handler);
+    const Options &options() const
+    {
+        return options_;
+    }
 
   private:
+    static Options resolve_options(Options options);
+    bool parse_request(const std::string &json, Request &req, std::string &response);
+    std::string calculate_response(const Request &req, const std::atomic<bool> *cancel,
+                                   bool &cacheable);
     void log_request(const Request &req);
+    void log_lane_stats();
+
+    Options options_;
+    ResponseCache<HttpResponse> response_cache_;
+
+  public:
+    ThreadPool pool_;
 };
 
 #endif /* MAHJONG_CPP_SERVER */
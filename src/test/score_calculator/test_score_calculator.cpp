@@ -0,0 +1,249 @@
+#define CATCH_CONFIG_MAIN
+#include <array>
+
+#include <catch2/catch.hpp>
+
+#include "mahjong/core/score_table.hpp"
+#include "mahjong/mahjong.hpp"
+
+using namespace mahjong;
+using score_calculator_detail::calc_score;
+
+namespace
+{
+
+enum
+{
+    RonDiscarderToDealer,
+    RonDiscarderToPlayer,
+    TsumoPlayerToDealer,
+    TsumoDealerToPlayer,
+    TsumoPlayerToPlayer,
+};
+
+// The hand-written tables used before ScoreTable::Payments was generated.
+const std::array<std::array<bool, 4>, 11> OldIsMangan = {{
+    // clang-format off
+    // 1han   2han   3han   4han
+    {false, false, false, false},  // 20fu
+    {false, false, false, false},  // 25fu
+    {false, false, false, false},  // 30fu
+    {false, false, false,  true},  // 40fu
+    {false, false, false,  true},  // 50fu
+    {false, false, false,  true},  // 60fu
+    {false, false,  true,  true},  // 70fu
+    {false, false,  true,  true},  // 80fu
+    {false, false,  true,  true},  // 90fu
+    {false, false,  true,  true},  // 100fu
+    {false, false,  true,  true},  // 110fu
+    // clang-format on
+}};
+
+// 0 means that the entry is not reachable or is Mangan.
+const std::array<std::array<std::array<int, 4>, 11>, 5> OldBelowMangan = {{
+    // (Ron) discarder -> dealer
+    {{
+        // clang-format off
+        // 1han   2han   3han   4han
+        {    0,     0,     0,     0}, // 20fu (20fu is Pinfu Tsumo only)
+        {    0,  2400,  4800,  9600}, // 25fu (25fu is Seven Pairs)
+        { 1500,  2900,  5800, 11600}, // 30fu
+        { 2000,  3900,  7700,     0}, // 40fu
+        { 2400,  4800,  9600,     0}, // 50fu
+        { 2900,  5800, 11600,     0}, // 60fu
+        { 3400,  6800,     0,     0}, // 70fu
+        { 3900,  7700,     0,     0}, // 80fu
+        { 4400,  8700,     0,     0}, // 90fu
+        { 4800,  9600,     0,     0}, // 100fu
+        { 5300, 10600,     0,     0}, // 110fu
+        // clang-format on
+    }},
+    // (Ron) discarder -> player
+    {{
+        // clang-format off
+        // 1han   2han   3han   4han
+        {    0,     0,     0,     0}, // 20fu (20fu is Pinfu Tsumo only)
+        {    0,  1600,  3200,  6400}, // 25fu (Seven Pairs)
+        { 1000,  2000,  3900,  7700}, // 30fu
+        { 1300,  2600,  5200,     0}, // 40fu
+        { 1600,  3200,  6400,     0}, // 50fu
+        { 2000,  3900,  7700,     0}, // 60fu
+        { 2300,  4500,     0,     0}, // 70fu
+        { 2600,  5200,     0,     0}, // 80fu
+        { 2900,  5800,     0,     0}, // 90fu
+        { 3200,  6400,     0,     0}, // 100fu
+        { 3600,  7100,     0,     0}, // 110fu
+        // clang-format on
+    }},
+    // (Tsumo) player -> dealer
+    {{
+        // clang-format off
+        // 1han   2han   3han   4han
+        {    0,   700,  1300,  2600}, // 20fu (Pinfu, Tsumo)
+        {    0,     0,  1600,  3200}, // 25fu (Seven Pairs, Tsumo)
+        {  500,  1000,  2000,  3900}, // 30fu
+        {  700,  1300,  2600,     0}, // 40fu
+        {  800,  1600,  3200,     0}, // 50fu
+        { 1000,  2000,  3900,     0}, // 60fu
+        { 1200,  2300,     0,     0}, // 70fu
+        { 1300,  2600,     0,     0}, // 80fu
+        { 1500,  2900,     0,     0}, // 90fu
+        { 1600,  3200,     0,     0}, // 100fu
+        { 1800,  3600,     0,     0}, // 110fu
+        // clang-format on
+    }},
+    // (Tsumo) dealer -> player
+    {{
+        // clang-format off
+        // 1han   2han   3han   4han
+        {    0,   700,  1300,  2600}, // 20fu (Pinfu, Tsumo)
+        {    0,     0,  1600,  3200}, // 25fu (Seven Pairs, Tsumo)
+        {  500,  1000,  2000,  3900}, // 30fu
+        {  700,  1300,  2600,     0}, // 40fu
+        {  800,  1600,  3200,     0}, // 50fu
+        { 1000,  2000,  3900,     0}, // 60fu
+        { 1200,  2300,     0,     0}, // 70fu
+        { 1300,  2600,     0,     0}, // 80fu
+        { 1500,  2900,     0,     0}, // 90fu
+        { 1600,  3200,     0,     0}, // 100fu
+        { 1800,  3600,     0,     0}, // 110fu
+        // clang-format on
+    }},
+    // (Tsumo) player -> player
+    {{
+        // clang-format off
+        // 1han   2han   3han   4han
+        {    0,   400,   700,  1300}, // 20fu (Pinfu, Tsumo)
+        {    0,     0,   800,  1600}, // 25fu (Seven Pairs, Tsumo)
+        {  300,   500,  1000,  2000}, // 30fu
+        {  400,   700,  1300,     0}, // 40fu
+        {  400,   800,  1600,     0}, // 50fu
+        {  500,  1000,  2000,     0}, // 60fu
+        {  600,  1200,     0,     0}, // 70fu
+        {  700,  1300,     0,     0}, // 80fu
+        {  800,  1500,     0,     0}, // 90fu
+        {  800,  1600,     0,     0}, // 100fu
+        {  900,   800,     0,     0}, // 110fu (2han is wrong, see below)
+        // clang-format on
+    }},
+}};
+
+const std::array<std::array<int, 11>, 5> OldAboveMangan = {{
+    // (Ron) discarder -> dealer
+    {12000, 18000, 24000, 36000, 48000, 48000, 96000, 144000, 192000, 240000, 288000},
+    // (Ron) discarder -> player
+    {8000, 12000, 16000, 24000, 32000, 32000, 64000, 96000, 128000, 160000, 192000},
+    // (Tsumo) player -> dealer
+    {4000, 6000, 8000, 12000, 16000, 16000, 32000, 48000, 64000, 80000, 96000},
+    // (Tsumo) dealer -> player
+    {4000, 6000, 8000, 12000, 16000, 16000, 32000, 48000, 64000, 80000, 96000},
+    // (Tsumo) player -> player
+    {2000, 3000, 4000, 6000, 8000, 8000, 16000, 24000, 32000, 40000, 48000},
+}};
+
+/**
+ * @brief Calculates the score and payments in the same way as calc_score() did with
+ *        the hand-written tables.
+ */
+std::array<int, 3> old_calc_score(const bool is_dealer, const bool is_tsumo,
+                                  const int honba, const int kyotaku,
+                                  const int game_mode, const int score_title,
+                                  const int han, const int fu)
+{
+    const auto points = [&](const int type) {
+        return score_title == ScoreLimit::Null
+                   ? OldBelowMangan[type][ScoreTable::fu_to_index(fu)][han - 1]
+                   : OldAboveMangan[type][score_title];
+    };
+    const int num_tsumo_payers = game_mode == GameMode::Sanma ? 2 : 3;
+
+    if (is_tsumo && is_dealer) {
+        const int player_payment = points(TsumoPlayerToDealer) + 100 * honba;
+        return {1000 * kyotaku + player_payment * num_tsumo_payers, player_payment, 0};
+    }
+    if (is_tsumo) {
+        const int dealer_payment = points(TsumoDealerToPlayer) + 100 * honba;
+        const int player_payment = points(TsumoPlayerToPlayer) + 100 * honba;
+        const int score =
+            1000 * kyotaku + dealer_payment + player_payment * (num_tsumo_payers - 1);
+        return {score, dealer_payment, player_payment};
+    }
+
+    const int honba_payment = (game_mode == GameMode::Sanma ? 200 : 300) * honba;
+    const int payment =
+        points(is_dealer ? RonDiscarderToDealer : RonDiscarderToPlayer) + honba_payment;
+    return {1000 * kyotaku + payment, payment, 0};
+}
+
+/**
+ * @brief Returns whether the old tables have the entry of the win.
+ */
+bool has_old_entry(const bool is_dealer, const bool is_tsumo, const int han,
+                   const int fu)
+{
+    const int fu_idx = ScoreTable::fu_to_index(fu);
+    if (is_tsumo) {
+        return OldBelowMangan[is_dealer ? TsumoPlayerToDealer : TsumoPlayerToPlayer]
+                             [fu_idx][han - 1] != 0;
+    }
+
+    return OldBelowMangan[is_dealer ? RonDiscarderToDealer : RonDiscarderToPlayer]
+                         [fu_idx][han - 1] != 0;
+}
+
+} // namespace
+
+TEST_CASE("Score table")
+{
+    SECTION("Non-dealer tsumo with 110 fu and 2 han")
+    {
+        // The hand-written table had non-dealers paying 800 instead of 1800.
+        const std::array<int, 3> expected = {7200, 3600, 1800};
+        REQUIRE(calc_score(false, true, 0, 0, GameMode::Yonma, ScoreLimit::Null, 2,
+                           110) == expected);
+        REQUIRE(old_calc_score(false, true, 0, 0, GameMode::Yonma, ScoreLimit::Null, 2,
+                               110)[2] == 800);
+    }
+
+    SECTION("Same as the hand-written tables")
+    {
+        for (int game_mode = 0; game_mode < GameMode::Length; ++game_mode) {
+            for (const bool is_dealer : {false, true}) {
+                for (const bool is_tsumo : {false, true}) {
+                    const auto check = [&](const int title, const int han,
+                                           const int fu) {
+                        for (int honba = 0; honba <= 2; ++honba) {
+                            for (int kyotaku = 0; kyotaku <= 2; ++kyotaku) {
+                                REQUIRE(calc_score(is_dealer, is_tsumo, honba, kyotaku,
+                                                   game_mode, title, han, fu) ==
+                                        old_calc_score(is_dealer, is_tsumo, honba,
+                                                       kyotaku, game_mode, title, han,
+                                                       fu));
+                            }
+                        }
+                    };
+
+                    for (int title = 0; title < ScoreLimit::Length; ++title) {
+                        check(title, 0, 0);
+                    }
+                    for (int fu_idx = 0; fu_idx < ScoreTable::NumFu; ++fu_idx) {
+                        const int fu = ScoreTable::index_to_fu(fu_idx);
+                        for (int han = 1; han <= ScoreTable::NumHan; ++han) {
+                            const bool is_fixed =
+                                !is_dealer && is_tsumo && fu == 110 && han == 2;
+                            if (has_old_entry(is_dealer, is_tsumo, han, fu) &&
+                                !is_fixed) {
+                                check(ScoreLimit::Null, han, fu);
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    SECTION("Mangan")
+    {
+        REQUIRE(ScoreTable::IsMangan == OldIsMangan);
+    }
+}
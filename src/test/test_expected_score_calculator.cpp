@@ -0,0 +1,227 @@
+#define CATCH_CONFIG_MAIN
+#include <numeric>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include <catch2/catch.hpp>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "mahjong/mahjong.hpp"
+
+using namespace mahjong;
+
+namespace
+{
+
+struct Situation
+{
+    TableConfig table_config;
+    RoundState round_state;
+    TableState table_state;
+    PlayerState player;
+    MergedCount wall;
+};
+
+/**
+ * @brief Creates the situation of the east player at the start of the game.
+ */
+Situation create_situation(const std::string &hand, const std::vector<Meld> &melds = {})
+{
+    Situation situation;
+    situation.table_config.rule_flags = RuleFlag::Default;
+    situation.table_config.game_mode = GameMode::Yonma;
+    situation.round_state.round_wind = Tile::East;
+    situation.round_state.round_number = 1;
+    situation.round_state.honba = 0;
+    situation.table_state.kyotaku = 0;
+    situation.table_state.dora_indicators = {Tile::East};
+    situation.player.hand = from_mpsz(hand);
+    situation.player.melds = melds;
+    situation.player.seat_wind = Tile::East;
+    situation.wall = create_wall(situation.table_config, situation.table_state,
+                                 situation.player, true);
+
+    return situation;
+}
+
+ExpectedScoreCalculator::Config create_config(const Situation &situation)
+{
+    ExpectedScoreCalculator::Config config;
+    config.sum =
+        std::accumulate(situation.wall.begin(), situation.wall.begin() + 34, 0);
+
+    return config;
+}
+
+std::tuple<std::vector<ExpectedScoreCalculator::Stat>, int>
+calc(const ExpectedScoreCalculator::Config &config, const Situation &situation,
+     ExpectedScoreCalculator::Context &context)
+{
+    return ExpectedScoreCalculator::calc(config, situation.table_config,
+                                         situation.round_state, situation.table_state,
+                                         situation.player, situation.wall, context);
+}
+
+/**
+ * @brief Checks that the statistics are the same up to the rounding errors, which
+ *        differ with the order in which the graph is built.
+ */
+void require_same_stats(const std::vector<ExpectedScoreCalculator::Stat> &actual,
+                        const std::vector<ExpectedScoreCalculator::Stat> &expected)
+{
+    REQUIRE(actual.size() == expected.size());
+    for (size_t i = 0; i < actual.size(); ++i) {
+        REQUIRE(actual[i].tile == expected[i].tile);
+        REQUIRE(actual[i].shanten == expected[i].shanten);
+        REQUIRE(actual[i].necessary_tiles == expected[i].necessary_tiles);
+        REQUIRE(actual[i].tenpai_prob.size() == expected[i].tenpai_prob.size());
+        for (size_t t = 0; t < actual[i].tenpai_prob.size(); ++t) {
+            REQUIRE(actual[i].tenpai_prob[t] ==
+                    Approx(expected[i].tenpai_prob[t]).margin(1e-9));
+            REQUIRE(actual[i].win_prob[t] ==
+                    Approx(expected[i].win_prob[t]).margin(1e-9));
+            REQUIRE(actual[i].exp_score[t] ==
+                    Approx(expected[i].exp_score[t]).margin(1e-6));
+        }
+    }
+}
+
+} // namespace
+
+#ifdef _OPENMP
+TEST_CASE("Expected score calculation with multiple threads")
+{
+    const int max_threads = omp_get_max_threads();
+    for (const auto &hand : {"222567m345p33667s", "23m3378p126s1256z"}) {
+        const Situation situation = create_situation(hand);
+        const ExpectedScoreCalculator::Config config = create_config(situation);
+        ExpectedScoreCalculator::Context context;
+
+        omp_set_num_threads(1);
+        const auto expected = std::get<0>(calc(config, situation, context));
+        REQUIRE(!expected.empty());
+
+        for (const int num_threads : {2, 3, 4, 8}) {
+            omp_set_num_threads(num_threads);
+            require_same_stats(std::get<0>(calc(config, situation, context)), expected);
+        }
+    }
+    omp_set_num_threads(max_threads);
+}
+#endif
+
+TEST_CASE("Expected score calculation with a search budget")
+{
+    const Situation situation = create_situation("23m3378p126s1256z");
+    ExpectedScoreCalculator::Config config = create_config(situation);
+    ExpectedScoreCalculator::Context context;
+
+    const auto [expected, expected_searched] = calc(config, situation, context);
+    REQUIRE(!context.is_approximate());
+
+    SECTION("Vertex limit")
+    {
+        config.max_vertices = expected_searched / 10;
+        const auto [stats, searched] = calc(config, situation, context);
+        REQUIRE(context.is_approximate());
+        REQUIRE(searched < expected_searched);
+
+        // The shortest paths are still searched, so every discard has a result.
+        REQUIRE(stats.size() == expected.size());
+        for (size_t i = 0; i < stats.size(); ++i) {
+            REQUIRE(stats[i].tile == expected[i].tile);
+            REQUIRE(stats[i].shanten == expected[i].shanten);
+        }
+    }
+
+    SECTION("Sufficient budget")
+    {
+        config.max_vertices = 2 * expected_searched;
+        const auto [stats, searched] = calc(config, situation, context);
+        REQUIRE(!context.is_approximate());
+        require_same_stats(stats, expected);
+        REQUIRE(searched == expected_searched);
+    }
+}
+
+TEST_CASE("Progressive expected score calculation")
+{
+    const std::vector<std::tuple<std::string, int>> cases = {
+        {"222567m345p33667s", 2},
+        {"23m3378p126s1256z", 1},
+    };
+    for (const auto &[hand, extra] : cases) {
+        const Situation situation = create_situation(hand);
+        ExpectedScoreCalculator::Config config = create_config(situation);
+        config.extra = extra;
+        ExpectedScoreCalculator::Context context;
+
+        const auto [expected, expected_searched] = calc(config, situation, context);
+
+        std::vector<int> passes;
+        std::vector<ExpectedScoreCalculator::Stat> last_stats;
+        const auto [stats, searched] = ExpectedScoreCalculator::calc_progressive(
+            config, situation.table_config, situation.round_state,
+            situation.table_state, situation.player, situation.wall, context,
+            [&](const std::vector<ExpectedScoreCalculator::Stat> &pass_stats, int,
+                const int extra) {
+                passes.push_back(extra);
+                last_stats = pass_stats;
+                return true;
+            });
+
+        // The graph extended pass by pass is the same as the one built at once.
+        std::vector<int> expected_passes(extra + 1);
+        std::iota(expected_passes.begin(), expected_passes.end(), 0);
+        REQUIRE(passes == expected_passes);
+        require_same_stats(last_stats, expected);
+        require_same_stats(stats, expected);
+        REQUIRE(searched == expected_searched);
+    }
+}
+
+TEST_CASE("Expected score calculation with symmetric hands merged")
+{
+    // The manzu and pinzu can be swapped in all the hands. The numbers can also be
+    // mirrored in the open hand, which can neither be all green nor get uradora.
+    const Meld pon{MeldType::Pon, {Tile::East, Tile::East, Tile::East}, Tile::East,
+                   SeatType::Kamicha};
+    const std::vector<std::tuple<std::string, std::vector<Meld>>> cases = {
+        {"23468m23468p1155z", {}},
+        {"2245m2245p113567s", {}},
+        {"1379m1379p5s55z", {pon}},
+    };
+    for (const auto &[hand, melds] : cases) {
+        const Situation situation = create_situation(hand, melds);
+        ExpectedScoreCalculator::Config config = create_config(situation);
+        ExpectedScoreCalculator::Context context;
+
+        config.enable_symmetry = false;
+        const auto [expected, expected_searched] = calc(config, situation, context);
+
+        config.enable_symmetry = true;
+        const auto [stats, searched] = calc(config, situation, context);
+        require_same_stats(stats, expected);
+        REQUIRE(searched < expected_searched);
+    }
+}
+
+TEST_CASE("Expected score calculation with the uradora cache")
+{
+    for (const auto &hand : {"222567m345p33667s", "23m3378p126s1256z"}) {
+        const Situation situation = create_situation(hand);
+        ExpectedScoreCalculator::Config config = create_config(situation);
+        ExpectedScoreCalculator::Context context;
+
+        config.enable_uradora_cache = false;
+        const auto [expected, expected_searched] = calc(config, situation, context);
+
+        config.enable_uradora_cache = true;
+        const auto [stats, searched] = calc(config, situation, context);
+        require_same_stats(stats, expected);
+        REQUIRE(searched == expected_searched);
+    }
+}
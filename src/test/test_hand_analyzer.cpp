@@ -0,0 +1,123 @@
+#define CATCH_CONFIG_MAIN
+#define CATCH_CONFIG_ENABLE_BENCHMARKING
+#include <cassert>
+#include <fstream>
+#include <iostream>
+
+#include <boost/algorithm/string/classification.hpp>
+#include <boost/algorithm/string/split.hpp>
+#include <boost/dll.hpp>
+#include <catch2/catch.hpp>
+#include <spdlog/spdlog.h>
+
+#include "mahjong/mahjong.hpp"
+
+using namespace mahjong;
+
+using TestCase = Hand;
+
+bool load_testcase(const std::string &filepath, std::vector<TestCase> &cases)
+{
+    cases.clear();
+
+    std::ifstream ifs(filepath);
+    if (!ifs) {
+        spdlog::error("Failed to open test case: {}.", filepath);
+        return false;
+    }
+
+    // The format is `<tile1> <tile2> ... <tile14>`
+    std::string line;
+    while (std::getline(ifs, line)) {
+        if (line.empty()) {
+            continue;
+        }
+
+        std::vector<std::string> tokens;
+        boost::split(tokens, line, boost::is_any_of(" "));
+
+        Hand hand{0};
+        for (int i = 0; i < 14; ++i) {
+            int tile = std::stoi(tokens[i]);
+            ++hand[Tile::to_normal(tile)];
+        }
+        assert(std::accumulate(hand.begin(), hand.begin() + 34, 0) == 14);
+
+        cases.push_back(hand);
+    }
+
+    spdlog::info("{} testcases loaded.", cases.size());
+
+    return true;
+}
+
+TEST_CASE("Hand analyzer")
+{
+    boost::filesystem::path filepath = boost::filesystem::path(CMAKE_TESTCASE_DIR) /
+                                       "test_unnecessary_tile_calculator.txt";
+
+    std::vector<TestCase> cases;
+    if (!load_testcase(filepath.string(), cases)) {
+        return;
+    }
+
+    SECTION("Hand analyzer")
+    {
+        for (auto hand : cases) {
+            for (int discard_tile = -1; discard_tile < 34; ++discard_tile) {
+                // Analyze the 14-tile hand and the 13-tile hands after a discard.
+                if (discard_tile >= 0 && hand[discard_tile] == 0) {
+                    continue;
+                }
+                if (discard_tile >= 0) {
+                    --hand[discard_tile];
+                }
+
+                const auto result =
+                    HandAnalyzer::calc(hand, 0, ShantenFlag::All, GameMode::Yonma);
+                const auto [type, shanten] =
+                    ShantenCalculator::calc(hand, 0, ShantenFlag::All, GameMode::Yonma);
+                const auto [_1, _2, necessary_tiles] = NecessaryTileCalculator::calc(
+                    hand, 0, ShantenFlag::All, GameMode::Yonma);
+                const auto [_3, _4, unnecessary_tiles] =
+                    UnnecessaryTileCalculator::calc(hand, 0, ShantenFlag::All,
+                                                    GameMode::Yonma);
+
+                INFO(fmt::format("手牌: {}", to_mpsz(hand)));
+                REQUIRE(result.type == type);
+                REQUIRE(result.shanten == shanten);
+                REQUIRE(result.regular_shanten ==
+                        std::get<1>(ShantenCalculator::calc(
+                            hand, 0, ShantenFlag::StandardHand, GameMode::Yonma)));
+                REQUIRE(result.seven_pairs_shanten ==
+                        std::get<1>(ShantenCalculator::calc(
+                            hand, 0, ShantenFlag::SevenPairs, GameMode::Yonma)));
+                REQUIRE(result.thirteen_orphans_shanten ==
+                        std::get<1>(ShantenCalculator::calc(
+                            hand, 0, ShantenFlag::ThirteenOrphans, GameMode::Yonma)));
+                REQUIRE(result.necessary_tiles == necessary_tiles);
+                REQUIRE(result.unnecessary_tiles == unnecessary_tiles);
+
+                if (discard_tile >= 0) {
+                    ++hand[discard_tile];
+                }
+            }
+        }
+    };
+
+    BENCHMARK("Hand analyzer")
+    {
+        for (const auto &hand : cases) {
+            HandAnalyzer::calc(hand, 0, ShantenFlag::All, GameMode::Yonma);
+        }
+    };
+
+    BENCHMARK("Shanten, necessary and unnecessary tile calculators")
+    {
+        for (const auto &hand : cases) {
+            ShantenCalculator::calc(hand, 0, ShantenFlag::All, GameMode::Yonma);
+            NecessaryTileCalculator::calc(hand, 0, ShantenFlag::All, GameMode::Yonma);
+            UnnecessaryTileCalculator::calc(hand, 0, ShantenFlag::All, GameMode::Yonma);
+        }
+    };
+}
@@ -0,0 +1,140 @@
+#define CATCH_CONFIG_MAIN
+#define CATCH_CONFIG_ENABLE_BENCHMARKING
+#include <cassert>
+#include <fstream>
+#include <iostream>
+
+#include <boost/algorithm/string/classification.hpp>
+#include <boost/algorithm/string/split.hpp>
+#include <boost/dll.hpp>
+#include <catch2/catch.hpp>
+#include <spdlog/spdlog.h>
+
+#include "mahjong/mahjong.hpp"
+
+using namespace mahjong;
+
+using TestCase = Hand;
+
+bool load_testcase(const std::string &filepath, std::vector<TestCase> &cases)
+{
+    cases.clear();
+
+    std::ifstream ifs(filepath);
+    if (!ifs) {
+        spdlog::error("Failed to open test case: {}.", filepath);
+        return false;
+    }
+
+    // The format is `<tile1> <tile2> ... <tile14>`
+    std::string line;
+    while (std::getline(ifs, line)) {
+        if (line.empty()) {
+            continue;
+        }
+
+        std::vector<std::string> tokens;
+        boost::split(tokens, line, boost::is_any_of(" "));
+
+        Hand hand{0};
+        for (int i = 0; i < 14; ++i) {
+            int tile = std::stoi(tokens[i]);
+            ++hand[Tile::to_normal(tile)];
+        }
+        assert(std::accumulate(hand.begin(), hand.begin() + 34, 0) == 14);
+
+        cases.push_back(hand);
+    }
+
+    spdlog::info("{} testcases loaded.", cases.size());
+
+    return true;
+}
+
+TEST_CASE("Incremental tile calculator")
+{
+    boost::filesystem::path filepath = boost::filesystem::path(CMAKE_TESTCASE_DIR) /
+                                       "test_unnecessary_tile_calculator.txt";
+
+    std::vector<TestCase> cases;
+    if (!load_testcase(filepath.string(), cases)) {
+        return;
+    }
+    cases.resize(std::min<size_t>(cases.size(), 10000));
+
+    SECTION("Incremental tile calculator")
+    {
+        for (auto hand : cases) {
+            IncrementalTileCalculator calculator(hand, 0, ShantenFlag::All,
+                                                 GameMode::Yonma);
+
+            INFO(fmt::format("手牌: {}", to_mpsz(hand)));
+            REQUIRE(calculator.result() ==
+                    UnnecessaryTileCalculator::calc(hand, 0, ShantenFlag::All,
+                                                    GameMode::Yonma));
+
+            for (int discard_tile = 0; discard_tile < 34; ++discard_tile) {
+                if (hand[discard_tile] == 0) {
+                    continue;
+                }
+
+                --hand[discard_tile];
+                calculator.discard(discard_tile);
+
+                INFO(fmt::format("手牌: {}", to_mpsz(hand)));
+                REQUIRE(calculator.result() ==
+                        NecessaryTileCalculator::calc(hand, 0, ShantenFlag::All,
+                                                      GameMode::Yonma));
+
+                for (int draw_tile = 0; draw_tile < 34; ++draw_tile) {
+                    if (hand[draw_tile] == 4) {
+                        continue;
+                    }
+
+                    ++hand[draw_tile];
+                    calculator.draw(draw_tile);
+
+                    INFO(fmt::format("手牌: {}", to_mpsz(hand)));
+                    REQUIRE(calculator.result() ==
+                            UnnecessaryTileCalculator::calc(
+                                hand, 0, ShantenFlag::All, GameMode::Yonma));
+
+                    --hand[draw_tile];
+                    calculator.discard(draw_tile);
+                }
+
+                ++hand[discard_tile];
+                calculator.draw(discard_tile);
+            }
+        }
+    };
+
+    BENCHMARK("Incremental tile calculator")
+    {
+        for (const auto &hand : cases) {
+            IncrementalTileCalculator calculator(hand, 0, ShantenFlag::StandardHand,
+                                                 GameMode::Yonma);
+            for (int tile = 0; tile < 34; ++tile) {
+                if (hand[tile]) {
+                    calculator.discard(tile);
+                    calculator.result();
+                    calculator.draw(tile);
+                }
+            }
+        }
+    };
+
+    BENCHMARK("Necessary tile calculator")
+    {
+        for (auto hand : cases) {
+            for (int tile = 0; tile < 34; ++tile) {
+                if (hand[tile]) {
+                    --hand[tile];
+                    NecessaryTileCalculator::calc(hand, 0, ShantenFlag::StandardHand,
+                                                  GameMode::Yonma);
+                    ++hand[tile];
+                }
+            }
+        }
+    };
+}
@@ -267,6 +267,7 @@ CalculationResult make_sample_result()
     result.stats = {stat1, stat2};
     result.searched = 42;
     result.time_us = 123456;
+    result.approximate = true;
 
     return result;
 }
@@ -627,7 +628,7 @@ TEST_CASE("build_success_response creates a schema-compliant success document")
 
     build_success_response(req, result, doc);
 
-    REQUIRE(doc.MemberCount() == 7);
+    REQUIRE(doc.MemberCount() == 9);
     REQUIRE(doc["success"].GetBool());
 
     const rapidjson::Value &input = doc["input"];
@@ -691,6 +692,24 @@ TEST_CASE("build_success_response creates a schema-compliant success document")
 
     REQUIRE(doc["searched"].GetInt() == 42);
     REQUIRE(doc["time"].GetInt64() == 123456);
+    REQUIRE(doc["approximate"].GetBool());
+    REQUIRE_FALSE(doc["cached"].GetBool());
 
     validate_response_schema(doc);
 }
+
+TEST_CASE("mark_cached_response marks a success response as cached")
+{
+    rapidjson::Document doc;
+    build_success_response(make_sample_request(), make_sample_result(), doc);
+
+    rapidjson::Document cached;
+    cached.Parse(mark_cached_response(dump_json(doc)).c_str());
+
+    REQUIRE(cached.MemberCount() == doc.MemberCount());
+    REQUIRE(cached["cached"].GetBool());
+    REQUIRE(cached["searched"].GetInt() == 42);
+    REQUIRE(cached["time"].GetInt64() == 123456);
+    REQUIRE(stringify_json(cached["stats"]) == stringify_json(doc["stats"]));
+    validate_response_schema(cached);
+}
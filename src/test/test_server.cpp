@@ -1,10 +1,14 @@
 #define CATCH_CONFIG_MAIN
 
 #include <atomic>
+#include <chrono>
 #include <condition_variable>
 #include <future>
+#include <memory>
 #include <mutex>
+#include <optional>
 #include <string>
+#include <vector>
 
 #include <catch2/catch.hpp>
 #include <rapidjson/document.h>
@@ -44,6 +48,14 @@ std::string make_valid_request_json()
     })";
 }
 
+Request make_request(const std::string &hand)
+{
+    Request req;
+    req.table_config.game_mode = mahjong::GameMode::Yonma;
+    req.player.hand = mahjong::from_mpsz(hand);
+    return req;
+}
+
 } // namespace
 
 TEST_CASE("process_http_post returns service unavailable when the queue is full")
@@ -67,7 +79,11 @@ TEST_CASE("process_http_post returns service unavailable when the queue is full"
         return std::string("done");
     };
 
-    Server test_server;
+    // Three workers, and a queue that holds twenty tasks of the default cost.
+    Server::Options options;
+    options.num_workers = 3;
+    options.max_queue_cost = 20;
+    Server test_server(options);
 
     for (int i = 0; i < 3; ++i) {
         test_server.pool_.enqueue(blocking_task);
@@ -96,3 +112,172 @@ TEST_CASE("process_http_post returns service unavailable when the queue is full"
     REQUIRE_FALSE(body["success"].GetBool());
     REQUIRE(std::string(body["err_msg"].GetString()) == "Server busy.");
 }
+
+TEST_CASE("estimate_cost grows with the shanten number")
+{
+    // The costs of the 13-tile hands are scaled by 13 / 14.
+    REQUIRE(estimate_cost(make_request("123456789m1234p")) == 1);
+    REQUIRE(estimate_cost(make_request("123456789m13p19s")) == 4);
+    REQUIRE(estimate_cost(make_request("12345m13579p159s")) == 92);
+    // Hands with 4 shanten or more are not searched.
+    REQUIRE(estimate_cost(make_request("1357m2468p159s12z")) == 1);
+}
+
+TEST_CASE("priority_lane separates cheap hands from deep shanten hands")
+{
+    const size_t tenpai_lane =
+        priority_lane(estimate_cost(make_request("123456789m1234p")));
+    const size_t one_shanten_lane =
+        priority_lane(estimate_cost(make_request("123456789m13p19s")));
+    const size_t three_shanten_lane =
+        priority_lane(estimate_cost(make_request("12345m13579p159s")));
+    const size_t four_shanten_lane =
+        priority_lane(estimate_cost(make_request("1357m2468p159s12z")));
+
+    REQUIRE(tenpai_lane == 0);
+    REQUIRE(one_shanten_lane == 0);
+    REQUIRE(three_shanten_lane == 2);
+    // Hands with 4 shanten or more get no statistics, and do not wait behind the
+    // search of 3-shanten hands.
+    REQUIRE(four_shanten_lane == 0);
+    REQUIRE(tenpai_lane != three_shanten_lane);
+}
+
+TEST_CASE("ThreadPool runs cheap lanes first without starving expensive lanes")
+{
+    std::promise<void> release_promise;
+    std::shared_future<void> release_future = release_promise.get_future().share();
+    std::promise<void> started_promise;
+
+    std::mutex order_mutex;
+    std::vector<size_t> order;
+
+    ThreadPool pool(1);
+    pool.enqueue([&] {
+        started_promise.set_value();
+        release_future.wait();
+    });
+    started_promise.get_future().wait();
+
+    auto record = [&](size_t lane) {
+        std::lock_guard<std::mutex> lock(order_mutex);
+        order.push_back(lane);
+    };
+
+    const size_t heavy_lane = ThreadPool::NumLanes - 1;
+    std::vector<std::future<void>> futures;
+    for (int i = 0; i < 6; ++i) {
+        futures.push_back(
+            pool.enqueue_with_cost(100, heavy_lane, record, heavy_lane).future);
+    }
+    for (int i = 0; i < 6; ++i) {
+        futures.push_back(pool.enqueue_with_cost(1, 0, record, size_t(0)).future);
+    }
+
+    release_promise.set_value();
+    for (auto &future : futures) {
+        future.get();
+    }
+
+    // The heavy lane goes first after being bypassed MaxBypassed times.
+    const std::vector<size_t> expected = {0, 0, 0, 0, heavy_lane, 0, 0,
+                                          heavy_lane, heavy_lane, heavy_lane,
+                                          heavy_lane, heavy_lane};
+    REQUIRE(order == expected);
+
+    const auto stats = pool.lane_stats();
+    REQUIRE(stats[0].enqueued == 7);
+    REQUIRE(stats[0].started == 7);
+    REQUIRE(stats[heavy_lane].enqueued == 6);
+    REQUIRE(stats[heavy_lane].started == 6);
+    REQUIRE(stats[heavy_lane].waiting_tasks == 0);
+}
+
+TEST_CASE("ResponseCache shares a calculation between identical requests")
+{
+    using Cache = ResponseCache<std::string>;
+    const Cache::Key key = {1, 2, 3};
+    const Cache::Key other_key = {1, 2, 4};
+
+    Cache cache(1, std::chrono::hours(1));
+    std::string value;
+    std::vector<std::string> received;
+    auto callback = [&](const std::string &response) { received.push_back(response); };
+    std::shared_ptr<Cancellation> first, joined;
+
+    REQUIRE(cache.find(key, value, callback, first) == Cache::Status::Miss);
+    REQUIRE(cache.find(key, value, callback, joined) == Cache::Status::Joined);
+    REQUIRE(joined == first);
+    REQUIRE(cache.find(key, value, callback, joined) == Cache::Status::Joined);
+    cache.complete(key, first, "response", "cached");
+    const std::vector<std::string> expected = {"response", "response"};
+    REQUIRE(received == expected);
+
+    // The cached response is stored as given, and a hit returns it unchanged.
+    REQUIRE(cache.find(key, value, callback, joined) == Cache::Status::Hit);
+    REQUIRE(value == "cached");
+
+    // The least recently used response is evicted.
+    std::shared_ptr<Cancellation> other;
+    REQUIRE(cache.find(other_key, value, callback, other) == Cache::Status::Miss);
+    cache.complete(other_key, other, "other", "other");
+    REQUIRE(cache.find(key, value, callback, first) == Cache::Status::Miss);
+    cache.complete(key, first, "busy", std::nullopt);
+    REQUIRE(cache.find(key, value, callback, first) == Cache::Status::Miss);
+
+    const Cache::Stats stats = cache.stats();
+    REQUIRE(stats.hits == 1);
+    REQUIRE(stats.joined == 2);
+    REQUIRE(stats.misses == 4);
+    REQUIRE(stats.size == 1);
+}
+
+TEST_CASE("ResponseCache expires responses after the TTL")
+{
+    using Cache = ResponseCache<std::string>;
+    const Cache::Key key = {1, 2, 3};
+
+    Cache cache(16, std::chrono::milliseconds(0));
+    std::string value;
+    auto callback = [](const std::string &) {};
+    std::shared_ptr<Cancellation> cancellation;
+
+    REQUIRE(cache.find(key, value, callback, cancellation) == Cache::Status::Miss);
+    cache.complete(key, cancellation, "response", "response");
+    REQUIRE(cache.find(key, value, callback, cancellation) == Cache::Status::Miss);
+}
+
+TEST_CASE("ResponseCache cancels a calculation abandoned by all requests")
+{
+    using Cache = ResponseCache<std::string>;
+    const Cache::Key key = {1, 2, 3};
+
+    Cache cache(16, std::chrono::hours(1));
+    std::string value;
+    std::vector<std::string> received;
+    auto callback = [&](const std::string &response) { received.push_back(response); };
+    std::shared_ptr<Cancellation> first, joined;
+
+    REQUIRE(cache.find(key, value, callback, first) == Cache::Status::Miss);
+    REQUIRE(cache.find(key, value, callback, joined) == Cache::Status::Joined);
+    first->abandon();
+    REQUIRE_FALSE(first->cancelled());
+    joined->abandon();
+    REQUIRE(first->cancelled());
+    REQUIRE(first->flag().load());
+
+    // A new request does not wait for the cancelled calculation.
+    std::shared_ptr<Cancellation> second;
+    REQUIRE(cache.find(key, value, callback, second) == Cache::Status::Miss);
+    REQUIRE(second != first);
+    REQUIRE_FALSE(second->cancelled());
+
+    // The cancelled calculation answers neither its abandoned requests nor the new one.
+    cache.complete(key, first, "cancelled", std::nullopt);
+    REQUIRE(received.empty());
+    REQUIRE(cache.find(key, value, callback, joined) == Cache::Status::Joined);
+    REQUIRE(joined == second);
+    cache.complete(key, second, "response", "response");
+    const std::vector<std::string> expected = {"response"};
+    REQUIRE(received == expected);
+}
@@ -169,3 +169,91 @@ TEST_CASE("Shanten number")
         }
     };
 }
+
+TEST_CASE("Batch shanten number")
+{
+    const auto &cases = reference_cases();
+    std::vector<Hand> hands;
+    for (const auto &[hand, regular, thirteen_orphans, seven_pairs] : cases) {
+        hands.push_back(hand);
+    }
+
+    SECTION("Batch shanten number")
+    {
+        for (int type : {ShantenFlag::StandardHand, ShantenFlag::All}) {
+            const auto results =
+                ShantenCalculator::calc_batch(hands, 0, type, GameMode::Yonma);
+            REQUIRE(results.size() == hands.size());
+            for (size_t i = 0; i < hands.size(); ++i) {
+                INFO(fmt::format("手牌: {}", to_mpsz(hands[i])));
+                REQUIRE(results[i] ==
+                        ShantenCalculator::calc(hands[i], 0, type, GameMode::Yonma));
+            }
+        }
+    }
+
+    SECTION("Batch shanten number of Sanma")
+    {
+        std::vector<Hand> sanma_hands;
+        for (const auto &hand : hands) {
+            if (!has_sanma_disabled_tiles(hand)) {
+                sanma_hands.push_back(hand);
+            }
+        }
+
+        const auto results = ShantenCalculator::calc_batch(
+            sanma_hands, 0, ShantenFlag::All, GameMode::Sanma);
+        for (size_t i = 0; i < sanma_hands.size(); ++i) {
+            INFO(fmt::format("手牌: {}", to_mpsz(sanma_hands[i])));
+            REQUIRE(results[i] == ShantenCalculator::calc(sanma_hands[i], 0,
+                                                          ShantenFlag::All,
+                                                          GameMode::Sanma));
+        }
+    }
+
+    SECTION("Batch shanten number with melds")
+    {
+        // Remove 3 tiles from the end of each hand per meld.
+        for (int num_melds = 1; num_melds <= 4; ++num_melds) {
+            std::vector<Hand> meld_hands;
+            for (Hand hand : hands) {
+                int num_removed = 0;
+                for (int tile = 33; tile >= 0 && num_removed < 3 * num_melds;) {
+                    if (hand[tile] > 0) {
+                        --hand[tile];
+                        ++num_removed;
+                    }
+                    else {
+                        --tile;
+                    }
+                }
+                meld_hands.push_back(hand);
+            }
+
+            const auto results = ShantenCalculator::calc_batch(
+                meld_hands, num_melds, ShantenFlag::All, GameMode::Yonma);
+            for (size_t i = 0; i < meld_hands.size(); ++i) {
+                INFO(fmt::format("手牌: {}, 副露数: {}", to_mpsz(meld_hands[i]),
+                                 num_melds));
+                REQUIRE(results[i] == ShantenCalculator::calc(meld_hands[i], num_melds,
+                                                              ShantenFlag::All,
+                                                              GameMode::Yonma));
+            }
+        }
+    }
+
+    std::vector<std::tuple<int, int>> results(hands.size());
+
+    BENCHMARK("Batch shanten number of standard hand")
+    {
+        ShantenCalculator::calc_batch(hands.data(), hands.size(), 0,
+                                      ShantenFlag::StandardHand, GameMode::Yonma,
+                                      results.data());
+    };
+
+    BENCHMARK("Batch shanten number")
+    {
+        ShantenCalculator::calc_batch(hands.data(), hands.size(), 0, ShantenFlag::All,
+                                      GameMode::Yonma, results.data());
+    };
+}
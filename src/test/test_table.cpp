@@ -0,0 +1,276 @@
+#define CATCH_CONFIG_MAIN
+#define CATCH_CONFIG_ENABLE_BENCHMARKING
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <vector>
+
+#include <catch2/catch.hpp>
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include "mahjong/mahjong.hpp"
+
+using namespace mahjong;
+
+namespace
+{
+
+/**
+ * @brief Lists all patterns of the given number of tiles with at most 14 tiles in
+ *        total.
+ */
+std::vector<std::vector<int>> list_patterns(const size_t num_tiles)
+{
+    std::vector<std::vector<int>> patterns;
+    std::vector<int> pattern(num_tiles, 0);
+    while (true) {
+        if (std::accumulate(pattern.begin(), pattern.end(), 0) <= 14) {
+            patterns.push_back(pattern);
+        }
+
+        size_t i = 0;
+        while (i < num_tiles && pattern[i] == 4) {
+            pattern[i++] = 0;
+        }
+        if (i == num_tiles) {
+            break;
+        }
+        ++pattern[i];
+    }
+
+    return patterns;
+}
+
+/**
+ * @brief Creates random hands of 14 tiles drawn from a full wall.
+ */
+std::vector<Hand> create_random_hands(const size_t num_hands)
+{
+    std::vector<int> wall;
+    for (int tile = 0; tile < 34; ++tile) {
+        wall.insert(wall.end(), 4, tile);
+    }
+
+    std::mt19937 engine(0);
+    std::vector<Hand> hands(num_hands);
+    for (auto &hand : hands) {
+        std::shuffle(wall.begin(), wall.end(), engine);
+        hand.fill(0);
+        for (int i = 0; i < 14; ++i) {
+            ++hand[wall[i]];
+        }
+    }
+
+    return hands;
+}
+
+/**
+ * @brief Computes the suits hash of the base-5 layout (USE_NYANTEN_TABLE=OFF).
+ */
+template <typename ForwardIterator>
+int32_t base5_hash(ForwardIterator first, ForwardIterator last)
+{
+    return std::accumulate(first, last, 0, [](int x, int y) { return 5 * x + y; });
+}
+
+/**
+ * @brief Computes the suits hash of the Nyanten layout (USE_NYANTEN_TABLE=ON).
+ */
+template <typename ForwardIterator>
+int32_t nyanten_hash(ForwardIterator first, ForwardIterator last)
+{
+    int32_t h = 0;
+    int i = 0;
+    int n = 0;
+    while (first != last) {
+        const int c = *first++;
+        n += c;
+        h += nyanten_suits_table[i][n][c];
+        ++i;
+    }
+
+    return h;
+}
+
+/**
+ * @brief Looks up the suits table of all hands with the given hash.
+ */
+template <typename Hash>
+int lookup_all(const std::vector<Hand> &hands,
+               const std::vector<Table::TableType> &table, Hash hash)
+{
+    int sum = 0;
+    for (const auto &hand : hands) {
+        for (int i = 0; i < 27; i += 9) {
+            sum += Table::distance(
+                table[hash(hand.begin() + i, hand.begin() + i + 9)], 4);
+        }
+    }
+
+    return sum;
+}
+
+enum class Cache
+{
+    L1d,
+    LastLevel,
+};
+
+/**
+ * @brief Counts the hardware cache misses while a function runs.
+ *
+ * @param cache cache whose read misses are counted
+ * @param f function to measure
+ * @return number of read misses, or -1 if the counter is not available
+ */
+template <typename Function> long long count_cache_misses(const Cache cache, Function f)
+{
+#ifdef __linux__
+    perf_event_attr attr{};
+    attr.type = PERF_TYPE_HW_CACHE;
+    attr.size = sizeof(attr);
+    attr.config =
+        (cache == Cache::L1d ? PERF_COUNT_HW_CACHE_L1D : PERF_COUNT_HW_CACHE_LL) |
+        (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+
+    const int fd = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+    if (fd == -1) {
+        f();
+        return -1;
+    }
+
+    ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+    ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+    f();
+    ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+    long long count = -1;
+    if (read(fd, &count, sizeof(count)) != sizeof(count)) {
+        count = -1;
+    }
+    close(fd);
+
+    return count;
+#else
+    (void)cache;
+    f();
+    return -1;
+#endif
+}
+
+} // namespace
+
+TEST_CASE("Table hash")
+{
+    SECTION("Suits hash")
+    {
+        std::vector<bool> used(Table::SuitsTableSize, false);
+        for (const auto &pattern : list_patterns(9)) {
+            const auto hash = Table::suits_hash(pattern.begin(), pattern.end());
+            REQUIRE(hash >= 0);
+            REQUIRE(static_cast<size_t>(hash) < Table::SuitsTableSize);
+            REQUIRE(!used[hash]);
+            used[hash] = true;
+        }
+    }
+
+    SECTION("Honors hash")
+    {
+        std::vector<bool> used(Table::HonorsTableSize, false);
+        for (const auto &pattern : list_patterns(7)) {
+            const auto hash = Table::honors_hash(pattern.begin(), pattern.end());
+            REQUIRE(hash >= 0);
+            REQUIRE(static_cast<size_t>(hash) < Table::HonorsTableSize);
+            REQUIRE(!used[hash]);
+            used[hash] = true;
+        }
+    }
+}
+
+TEST_CASE("Table lookup")
+{
+    const std::vector<Hand> hands = create_random_hands(100000);
+
+    BENCHMARK("Suits table lookup of random hands")
+    {
+        int sum = 0;
+        for (const auto &hand : hands) {
+            for (int i = 0; i < 27; i += 9) {
+                const auto hash =
+                    Table::suits_hash(hand.begin() + i, hand.begin() + i + 9);
+                sum += Table::distance(Table::suits_table_[hash], 4);
+            }
+        }
+        return sum;
+    };
+
+    BENCHMARK("Shanten number of random hands")
+    {
+        int sum = 0;
+        for (const auto &hand : hands) {
+            sum += std::get<1>(
+                ShantenCalculator::calc(hand, 0, ShantenFlag::All, GameMode::Yonma));
+        }
+        return sum;
+    };
+}
+
+TEST_CASE("Table layouts")
+{
+    // Copy the loaded suits table into both layouts so that they are compared in the
+    // same build. The entries are the same, only the hash and the table size differ.
+    std::vector<Table::TableType> base5_table(1943751);
+    std::vector<Table::TableType> nyanten_table(405350);
+    for (const auto &pattern : list_patterns(9)) {
+        const auto &entry =
+            Table::suits_table_[Table::suits_hash(pattern.begin(), pattern.end())];
+        base5_table[base5_hash(pattern.begin(), pattern.end())] = entry;
+        nyanten_table[nyanten_hash(pattern.begin(), pattern.end())] = entry;
+    }
+
+    const std::vector<Hand> hands = create_random_hands(100000);
+    const auto base5_lookup = [&] {
+        return lookup_all(hands, base5_table, [](auto first, auto last) {
+            return base5_hash(first, last);
+        });
+    };
+    const auto nyanten_lookup = [&] {
+        return lookup_all(hands, nyanten_table, [](auto first, auto last) {
+            return nyanten_hash(first, last);
+        });
+    };
+    REQUIRE(base5_lookup() == nyanten_lookup());
+
+    // Cache misses of one pass over the hands, -1 if the counters are not available
+    // (e.g. restricted by perf_event_paranoid or on other platforms).
+    int sum = 0;
+    for (const auto cache : {Cache::L1d, Cache::LastLevel}) {
+        const auto base5_misses =
+            count_cache_misses(cache, [&] { sum += base5_lookup(); });
+        const auto nyanten_misses =
+            count_cache_misses(cache, [&] { sum += nyanten_lookup(); });
+        std::cout << (cache == Cache::L1d ? "L1d" : "LLC")
+                  << " read misses: base-5 " << base5_misses << ", Nyanten "
+                  << nyanten_misses << std::endl;
+    }
+    REQUIRE(sum != 0);
+
+    BENCHMARK("Suits table lookup with the base-5 layout")
+    {
+        return base5_lookup();
+    };
+
+    BENCHMARK("Suits table lookup with the Nyanten layout")
+    {
+        return nyanten_lookup();
+    };
+}
@@ -0,0 +1,84 @@
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#include <boost/filesystem.hpp>
+#include <spdlog/spdlog.h>
+
+#include "mahjong/core/hand_separator.hpp"
+
+using namespace mahjong;
+
+/**
+ * @brief 面子パターンのテーブルをマップ用のテーブルファイルに書き込む。
+ *
+ * @param filename ファイル名
+ * @param table テーブル
+ * @return 書き込みに成功した場合は true、そうでない場合は false を返す。
+ */
+bool write_mapped_file(const std::string &filename,
+                       const HandSeparator::PatternTable &table)
+{
+    HandSeparator::MappedTableHeader header{};
+    header.magic = HandSeparator::MappedTableMagic;
+    header.version = HandSeparator::MappedTableVersion;
+    header.block_size = sizeof(Block);
+    header.table_size = table.table_size;
+    header.num_patterns = table.num_patterns;
+    header.num_blocks = table.num_blocks;
+    header.checksum = HandSeparator::checksum(table);
+
+    std::ofstream file(filename, std::ios::binary);
+    if (!file) {
+        std::cerr << "Failed to open table file. (path: " << filename << ")"
+                  << std::endl;
+        return false;
+    }
+
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char *>(table.pattern_offsets),
+               (table.table_size + 1) * sizeof(uint32_t));
+    file.write(reinterpret_cast<const char *>(table.block_offsets),
+               (table.num_patterns + 1) * sizeof(uint32_t));
+    file.write(reinterpret_cast<const char *>(table.blocks),
+               table.num_blocks * sizeof(Block));
+
+    file.close();
+    if (!file) {
+        std::cerr << "Failed to write table file. (path: " << filename << ")"
+                  << std::endl;
+        return false;
+    }
+
+    std::cout << "Table file written. (path: " << filename << ")" << std::endl;
+
+    return true;
+}
+
+int main(int argc, char *argv[])
+{
+    // The output directory can be given as the first argument. By default the tables
+    // are written to the build directory, and copied next to the programs from there.
+    const boost::filesystem::path output_dir = argc > 1 ? argv[1] : PATTERN_TABLE_DIR;
+    boost::filesystem::create_directories(output_dir);
+
+    // The tables are loaded from the JSON files next to the executable on startup.
+    if (!HandSeparator::initialize()) {
+        spdlog::error("Failed to load pattern files.");
+        return 1;
+    }
+
+    auto start = std::chrono::high_resolution_clock::now();
+    const bool success =
+        write_mapped_file((output_dir / "suits_patterns.map").string(),
+                          HandSeparator::suits_table_) &&
+        write_mapped_file((output_dir / "honors_patterns.map").string(),
+                          HandSeparator::honors_table_);
+    auto end = std::chrono::high_resolution_clock::now();
+    auto elapsed_ms =
+        std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
+    spdlog::info("Elapsed time: {} ms", elapsed_ms);
+
+    return success ? 0 : 1;
+}
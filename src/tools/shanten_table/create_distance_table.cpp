@@ -289,45 +289,104 @@ bool write_file(const std::string &filename,
     return true;
 }
 
-void create_shanten_table()
+bool write_mapped_file(const std::string &filename,
+                       const std::map<Table::HashType, ValueType> &table,
+                       const size_t table_size)
+{
+    std::vector<Table::TableType> entries(table_size);
+    for (const auto &[hash, distances] : table) {
+        for (size_t i = 0; i < distances.size(); ++i) {
+            Table::set_entry(entries[hash], static_cast<int>(i), distances[i]);
+        }
+    }
+
+    Table::MappedTableHeader header{};
+    header.magic = Table::MappedTableMagic;
+    header.version = Table::MappedTableVersion;
+    header.flags = Table::MappedTableFlags;
+    header.entry_size = sizeof(Table::TableType);
+    header.table_size = table_size;
+    header.checksum = Table::checksum(entries.data(), entries.size());
+
+    std::ofstream file(filename, std::ios::binary);
+    if (!file) {
+        std::cerr << "Failed to open table file. (path: " << filename << ")"
+                  << std::endl;
+        return false;
+    }
+
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char *>(entries.data()),
+               entries.size() * sizeof(Table::TableType));
+
+    file.close();
+    if (!file) {
+        std::cerr << "Failed to write table file. (path: " << filename << ")"
+                  << std::endl;
+        return false;
+    }
+
+    std::cout << "Table file written. (path: " << filename << ")" << std::endl;
+
+    return true;
+}
+
+bool create_shanten_table(const boost::filesystem::path &output_dir)
 {
     spdlog::info("Creating suits table...");
 #ifdef USE_NYANTEN_TABLE
-    boost::filesystem::path suits_table_path =
-        boost::filesystem::path(CMAKE_CONFIG_DIR) / "suits_table_nyanten.bin";
+    boost::filesystem::path suits_table_path = output_dir / "suits_table_nyanten.bin";
 #else
-    boost::filesystem::path suits_table_path =
-        boost::filesystem::path(CMAKE_CONFIG_DIR) / "suits_table.bin";
+    boost::filesystem::path suits_table_path = output_dir / "suits_table.bin";
 #endif
     auto suits_patterns = list_suits_patterns();
     auto suits_win_patterns = list_suits_win_patterns();
     auto suits_table = create_table(suits_patterns, suits_win_patterns);
-    write_file(suits_table_path.string(), suits_table);
+    const boost::filesystem::path suits_mapped_path =
+        boost::filesystem::path(suits_table_path).replace_extension(".map");
+    if (!write_file(suits_table_path.string(), suits_table) ||
+        !write_mapped_file(suits_mapped_path.string(), suits_table,
+                           static_cast<size_t>(suits_table.rbegin()->first) + 1)) {
+        return false;
+    }
     spdlog::info("suits patterns: {}", suits_patterns.size());
     spdlog::info("suits win patterns: {}", suits_win_patterns.size());
 
     spdlog::info("Creating honors table...");
 #ifdef USE_NYANTEN_TABLE
-    boost::filesystem::path honors_table_path =
-        boost::filesystem::path(CMAKE_CONFIG_DIR) / "honors_table_nyanten.bin";
+    boost::filesystem::path honors_table_path = output_dir / "honors_table_nyanten.bin";
 #else
-    boost::filesystem::path honors_table_path =
-        boost::filesystem::path(CMAKE_CONFIG_DIR) / "honors_table.bin";
+    boost::filesystem::path honors_table_path = output_dir / "honors_table.bin";
 #endif
     auto honors_patterns = list_honors_patterns();
     auto honors_win_patterns = list_honors_win_patterns();
     auto honors_table = create_table(honors_patterns, honors_win_patterns);
-    write_file(honors_table_path.string(), honors_table);
+    const boost::filesystem::path honors_mapped_path =
+        boost::filesystem::path(honors_table_path).replace_extension(".map");
+    if (!write_file(honors_table_path.string(), honors_table) ||
+        !write_mapped_file(honors_mapped_path.string(), honors_table,
+                           static_cast<size_t>(honors_table.rbegin()->first) + 1)) {
+        return false;
+    }
     spdlog::info("honors patterns: {}", honors_patterns.size());
     spdlog::info("honors win patterns: {}", honors_win_patterns.size());
+
+    return true;
 }
 
-int main()
+int main(int argc, char *argv[])
 {
+    // The output directory can be given as the first argument. By default the tables
+    // are written to the build directory and installed from there.
+    const boost::filesystem::path output_dir = argc > 1 ? argv[1] : SHANTEN_TABLE_DIR;
+    boost::filesystem::create_directories(output_dir);
+
     auto start = std::chrono::high_resolution_clock::now();
-    create_shanten_table();
+    const bool success = create_shanten_table(output_dir);
     auto end = std::chrono::high_resolution_clock::now();
     auto elapsed_s =
         std::chrono::duration_cast<std::chrono::seconds>(end - start).count();
     spdlog::info("Elapsed time: {} s", elapsed_s);
+
+    return success ? 0 : 1;
 }